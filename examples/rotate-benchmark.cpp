@@ -0,0 +1,92 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <pixglot/conversions.hpp>
+#include <pixglot/pixel-buffer.hpp>
+#include <pixglot/pixel-format.hpp>
+#include <pixglot/square-isometry.hpp>
+
+
+
+[[nodiscard]] pixglot::pixel_buffer create_buffer(
+    size_t                width,
+    size_t                height,
+    pixglot::pixel_format format
+) {
+  pixglot::pixel_buffer buffer{width, height, format};
+
+  auto data = buffer.data();
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<std::byte>(i * 31);
+  }
+
+  return buffer;
+}
+
+
+
+[[nodiscard]] std::chrono::microseconds measure(
+    const pixglot::pixel_buffer& source,
+    pixglot::square_isometry     orientation,
+    size_t                       repetitions
+) {
+  std::chrono::microseconds best{std::chrono::microseconds::max()};
+
+  for (size_t i = 0; i < repetitions; ++i) {
+    auto buffer = source;
+
+    auto start = std::chrono::steady_clock::now();
+    pixglot::convert_orientation(buffer, orientation);
+    auto end   = std::chrono::steady_clock::now();
+
+    best = std::min(best, std::chrono::duration_cast<std::chrono::microseconds>(end - start));
+  }
+
+  return best;
+}
+
+
+
+int main(int argc, char** argv) {
+  if (argc != 1 && argc != 3 && argc != 4) {
+    std::cout << "Usage: " << argv[0] << " [<width> <height> [<repetitions>]]\n"
+      "Measure the best time of the transposing rotations on synthetic pixel buffers\n";
+    return 1;
+  }
+
+  //NOLINTBEGIN(*-pointer-arithmetic)
+  size_t width       = argc > 1 ? std::stoul(argv[1]) : 4096;
+  size_t height      = argc > 2 ? std::stoul(argv[2]) : 3072;
+  size_t repetitions = argc > 3 ? std::stoul(argv[3]) : 5;
+  //NOLINTEND(*-pointer-arithmetic)
+
+  for (const auto& kernel: pixglot::cpu_kernels()) {
+    std::cout << kernel.name << ": " << kernel.variant << '\n';
+  }
+  std::cout << '\n';
+
+  using enum pixglot::square_isometry;
+
+  for (auto format: {pixglot::gray<pixglot::u8>::format(),
+                     pixglot::gray_a<pixglot::u8>::format(),
+                     pixglot::rgb<pixglot::u8>::format(),
+                     pixglot::rgba<pixglot::u8>::format(),
+                     pixglot::rgba<pixglot::u16>::format(),
+                     pixglot::rgba<pixglot::f32>::format()}) {
+
+    auto source = create_buffer(width, height, format);
+
+    std::cout << std::setw(10) << std::left << pixglot::to_string(format);
+
+    for (auto orientation: {transpose, rotate_cw, rotate_ccw, anti_transpose}) {
+      auto time = measure(source, orientation, repetitions);
+
+      std::cout << "  " << pixglot::to_string(orientation) << ": "
+        << std::setw(8) << std::right << time.count() << "µs";
+    }
+
+    std::cout << '\n';
+  }
+}
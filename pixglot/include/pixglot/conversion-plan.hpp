@@ -0,0 +1,71 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_CONVERSION_PLAN_HPP_INCLUDED
+#define PIXGLOT_CONVERSION_PLAN_HPP_INCLUDED
+
+#include "pixglot/frame.hpp"
+#include "pixglot/output-format.hpp"
+#include "pixglot/pixel-format.hpp"
+#include "pixglot/square-isometry.hpp"
+
+#include <bit>
+#include <experimental/propagate_const>
+#include <memory>
+
+
+
+namespace pixglot {
+
+class image;
+
+struct frame_description {
+  pixglot::storage_type storage_type{storage_type::pixel_buffer};
+  pixel_format          format;
+  std::endian           endian      {std::endian::native};
+  pixglot::alpha_mode   alpha_mode  {alpha_mode::none};
+  float                 gamma       {gamma_s_rgb};
+  square_isometry       orientation {square_isometry::identity};
+
+  [[nodiscard]] bool operator==(const frame_description&) const = default;
+};
+
+[[nodiscard]] frame_description describe(const frame&);
+
+
+
+// Everything make_format_compatible derives for a frame, resolved once for all frames
+// with the same description: the target description, the conversion parameters, and
+// the conversion kernel.
+class conversion_plan {
+  public:
+    conversion_plan(const conversion_plan&);
+    conversion_plan(conversion_plan&&) noexcept;
+    conversion_plan& operator=(const conversion_plan&);
+    conversion_plan& operator=(conversion_plan&&) noexcept;
+
+    ~conversion_plan();
+
+    conversion_plan(const frame_description&, const output_format&, bool = false);
+
+
+
+    [[nodiscard]] const frame_description& source() const;
+    [[nodiscard]] const frame_description& target() const;
+
+    [[nodiscard]] bool applicable(const frame&) const;
+    [[nodiscard]] bool converts_pixels()        const;
+
+    void apply(frame&) const;
+    void apply(image&) const;
+
+
+
+  private:
+    class impl;
+    std::experimental::propagate_const<std::unique_ptr<impl>> impl_;
+};
+
+}
+
+#endif // PIXGLOT_CONVERSION_PLAN_HPP_INCLUDED
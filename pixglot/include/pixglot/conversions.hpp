@@ -6,14 +6,24 @@
 
 #include "pixglot/image.hpp"
 
+#include <string_view>
+#include <vector>
+
 
 
 namespace pixglot {
 
+// Conversions of an image first move the layers of image::texture_array back into
+// textures of their frames.
+
+// see gamma_s_rgb for the transfer function used
 void convert_gamma(image&, float);
 void convert_gamma(frame&, float);
 void convert_gamma(pixel_buffer&,  float, float);
 void convert_gamma(gl_texture&,    float, float);
+void convert_gamma(indexed_buffer&, float, float);
+// throws base_exception unless current and target match, frames are expanded instead
+void convert_gamma(yuv_buffer&,    float, float);
 
 void convert_endian(image&,        std::endian = std::endian::native);
 void convert_endian(frame&,        std::endian = std::endian::native);
@@ -23,7 +33,11 @@ void convert_orientation(image&, square_isometry = {});
 void convert_orientation(frame&, square_isometry = {});
 void convert_orientation(pixel_buffer&,  square_isometry, square_isometry = {});
 void convert_orientation(gl_texture&,    square_isometry, square_isometry = {});
+void convert_orientation(indexed_buffer&, square_isometry, square_isometry = {});
+// throws base_exception unless source and target match, frames are expanded instead
+void convert_orientation(yuv_buffer&,    square_isometry, square_isometry = {});
 
+// throws base_exception when converting to storage_type::indexed or storage_type::yuv
 void convert_storage(image&, storage_type);
 void convert_storage(frame&, storage_type);
 
@@ -36,6 +50,28 @@ void convert_alpha_mode(image&, alpha_mode);
 void convert_alpha_mode(frame&, alpha_mode);
 void convert_alpha_mode(pixel_buffer&, alpha_mode, alpha_mode);
 void convert_alpha_mode(gl_texture&,   alpha_mode, alpha_mode);
+void convert_alpha_mode(indexed_buffer&, alpha_mode, alpha_mode);
+// no-op, yuv buffers do not have an alpha channel
+void convert_alpha_mode(yuv_buffer&,    alpha_mode, alpha_mode);
+
+
+
+// Identifies the GL context current on this thread, e.g. by its EGLContext or
+// GLXContext, and must be set again after switching contexts. GL conversions keep
+// their framebuffer and quad per key. Without a key they create both for every
+// conversion and only reuse shader programs.
+void gl_context_key(const void*);
+
+
+
+// Implementation selected at runtime for each cpu conversion kernel; without cpu
+// conversions only the endian and palette kernels are listed
+struct cpu_kernel {
+  std::string_view name;
+  std::string_view variant;
+};
+
+[[nodiscard]] std::vector<cpu_kernel> cpu_kernels();
 
 }
 
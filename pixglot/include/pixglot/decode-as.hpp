@@ -0,0 +1,149 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_DECODE_AS_HPP_INCLUDED
+#define PIXGLOT_DECODE_AS_HPP_INCLUDED
+
+#include "pixglot/conversions.hpp"
+#include "pixglot/decode.hpp"
+#include "pixglot/image-view.hpp"
+#include "pixglot/typed-image.hpp"
+
+#include <type_traits>
+#include <utility>
+
+
+
+namespace pixglot::details {
+  template<typename T>
+  [[nodiscard]] T luma(T r, T g, T b) {
+    if constexpr (std::is_integral_v<T>) {
+      return static_cast<T>(0.2126 * r + 0.7152 * g + 0.0722 * b + 0.5);
+    } else {
+      return static_cast<T>(0.2126f * static_cast<f32>(r)
+          + 0.7152f * static_cast<f32>(g) + 0.0722f * static_cast<f32>(b));
+    }
+  }
+
+
+
+  template<pixel_type P, pixel_type Source>
+  [[nodiscard]] P reduce_pixel(const Source& px) {
+    P out{};
+
+    if constexpr (has_color(P::format().channels)) {
+      out.r = px.r;
+      out.g = px.g;
+      out.b = px.b;
+    } else if constexpr (has_color(Source::format().channels)) {
+      out.v = luma(px.r, px.g, px.b);
+    } else {
+      out.v = px.v;
+    }
+
+    if constexpr (has_alpha(P::format().channels)) {
+      out.a = px.a;
+    }
+
+    return out;
+  }
+
+
+
+  template<pixel_type P, pixel_type Source>
+  void reduce_pixels(const pixel_buffer& source, pixel_buffer& target) {
+    static constexpr auto channels = Source::format().channels;
+    static constexpr auto format   = P::format();
+
+    if constexpr ((has_color(channels) || !has_color(format.channels)) &&
+                  (has_alpha(channels) || !has_alpha(format.channels))) {
+      image_view<const Source> input{source};
+      image_view<P>            output{target};
+
+      for (size_t y = 0; y < input.height(); ++y) {
+        for (size_t x = 0; x < input.width(); ++x) {
+          output[x, y] = reduce_pixel<P>(input[x, y]);
+        }
+      }
+    }
+  }
+
+
+
+  // Replaces the pixel buffers in img that have more channels than P by buffers of
+  // format P with the given endian.
+  template<pixel_type P, std::endian Endian>
+  void reduce_channels(image& img) {
+    using C = typename P::component;
+    static constexpr auto format = P::format();
+
+    for (auto& f: img.frames()) {
+      if (f.type() != storage_type::pixel_buffer || f.format() == format ||
+          f.format().format != format.format ||
+          !color_channels_contained(format.channels, f.format().channels)) {
+        continue;
+      }
+
+      auto& pixels = f.pixels();
+      convert_endian(pixels, std::endian::native);
+
+      pixel_buffer target{pixels.width(), pixels.height(), format};
+      switch (pixels.format().channels) {
+        case color_channels::gray:   reduce_pixels<P, gray  <C>>(pixels, target); break;
+        case color_channels::gray_a: reduce_pixels<P, gray_a<C>>(pixels, target); break;
+        case color_channels::rgb:    reduce_pixels<P, rgb   <C>>(pixels, target); break;
+        case color_channels::rgba:   reduce_pixels<P, rgba  <C>>(pixels, target); break;
+      }
+      convert_endian(target, Endian);
+
+      f.reset(std::move(target));
+
+      if (!has_alpha(format.channels)) {
+        f.alpha_mode(alpha_mode::none);
+      }
+    }
+  }
+}
+
+
+
+namespace pixglot {
+
+// Decodes into frames of the compile-time format P, the output_format may set the
+// remaining properties like gamma or orientation.
+// Frames decoded with more channels than P are reduced: alpha is dropped and color is
+// replaced by its luma, Rec. 709 weights applied to the encoded values as they are,
+// without linearising them first.
+template<
+  pixel_type          P,
+  std::endian         Endian = std::endian::native,
+  pixglot::alpha_mode Alpha  = default_alpha_mode<P>
+>
+[[nodiscard]] typed_image<P, Endian, Alpha> decode_as(
+    reader&               input,
+    progress_access_token pat  = {},
+    const output_format&  base = {}
+) {
+  using result = typed_image<P, Endian, Alpha>;
+
+  auto img = decode(input, std::move(pat), result::output_format(base));
+  details::reduce_channels<P, Endian>(img);
+  return result{std::move(img)};
+}
+
+template<
+  pixel_type          P,
+  std::endian         Endian = std::endian::native,
+  pixglot::alpha_mode Alpha  = default_alpha_mode<P>
+>
+[[nodiscard]] typed_image<P, Endian, Alpha> decode_as(
+    reader&&              input,
+    progress_access_token pat  = {},
+    const output_format&  base = {}
+) {
+  return decode_as<P, Endian, Alpha>(input, std::move(pat), base);
+}
+
+}
+
+#endif // PIXGLOT_DECODE_AS_HPP_INCLUDED
@@ -0,0 +1,64 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_DETAILS_CPU_DISPATCH_HPP_INCLUDED
+#define PIXGLOT_DETAILS_CPU_DISPATCH_HPP_INCLUDED
+
+#include <initializer_list>
+#include <string_view>
+
+
+
+namespace pixglot::details {
+
+// Ordered from least to most capable, the environment variable PIXGLOT_CPU_DISPATCH
+// set to one of the names disables all variants further down the list.
+enum class instruction_set {
+  generic,
+  sse2,
+  ssse3,
+  sse4_1,
+  avx,
+  f16c,
+  avx2,
+  avx512bw,
+  neon,
+};
+
+[[nodiscard]] std::string_view stringify(instruction_set);
+
+[[nodiscard]] bool cpu_supports(instruction_set);
+
+void register_kernel(std::string_view, instruction_set);
+
+
+
+template<typename Kernel>
+struct kernel_variant {
+  instruction_set isa;
+  Kernel*         kernel;
+};
+
+// Selects the first variant supported by the cpu, variants are listed from best to
+// worst and end with the generic one.
+template<typename Kernel>
+[[nodiscard]] Kernel* select_kernel(
+    std::string_view                              name,
+    std::initializer_list<kernel_variant<Kernel>> variants
+) {
+  const kernel_variant<Kernel>* selected{nullptr};
+
+  for (const auto& variant: variants) {
+    selected = &variant;
+    if (cpu_supports(variant.isa)) {
+      break;
+    }
+  }
+
+  register_kernel(name, selected->isa);
+  return selected->kernel;
+}
+
+}
+
+#endif // PIXGLOT_DETAILS_CPU_DISPATCH_HPP_INCLUDED
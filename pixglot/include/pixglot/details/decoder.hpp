@@ -4,6 +4,8 @@
 #ifndef PIXGLOT_DETAILS_DECODER_HPP_INCLUDED
 #define PIXGLOT_DETAILS_DECODER_HPP_INCLUDED
 
+#include "pixglot/conversion-plan.hpp"
+#include "pixglot/details/unpack-ring.hpp"
 #include "pixglot/image.hpp"
 #include "pixglot/output-format.hpp"
 #include "pixglot/progress-token.hpp"
@@ -21,11 +23,21 @@ class decoder {
 
 
     [[nodiscard]] bool wants_pixel_transfer() const;
+    [[nodiscard]] bool wants_indexed()        const;
+    [[nodiscard]] bool wants_yuv()            const;
 
 
 
     frame& begin_frame(size_t, size_t, pixel_format, std::endian = std::endian::native);
+    // target() receives the indices, only valid if wants_indexed()
+    frame& begin_frame(indexed_buffer);
+    // target() receives the luma plane, only valid if wants_yuv()
+    frame& begin_frame(yuv_buffer);
     void   begin_pixel_transfer();
+    // For codecs writing each row once from top to bottom through target_row. Texture
+    // frames then only keep a strip of rows in memory, which is uploaded whenever
+    // target_row moves past it.
+    void   begin_strip_transfer();
     void   finish_pixel_transfer();
     void   finish_frame();
 
@@ -33,6 +45,10 @@ class decoder {
 
     [[nodiscard]] pixel_buffer& target();
 
+    [[nodiscard]] std::span<std::byte> target_row(size_t);
+    // number of consecutive rows from y on which target_row serves from one strip
+    [[nodiscard]] size_t               target_rows_from(size_t y) const;
+
     [[nodiscard]] pixglot::image& image() {
       return image_;
     }
@@ -66,6 +82,9 @@ class decoder {
     std::optional<pixglot::output_format>
                                   format_replacement_;
     const pixglot::output_format* format_;
+    const pixglot::output_format* requested_format_;
+    std::optional<conversion_plan>
+                                  plan_;
 
     size_t                        frame_total_{1};
     size_t                        frame_index_{0};
@@ -74,8 +93,29 @@ class decoder {
     std::optional<pixel_buffer>   pixel_target_;
     pixel_buffer*                 target_{};
 
+    std::endian                   target_endian_{std::endian::native};
+    bool                          strip_{false};
+    size_t                        strip_begin_{0};
+
     size_t                        uploaded_{};
     int                           upload_direction_{};
+
+    std::optional<bool>           unpack_ring_supported_;
+    std::optional<unpack_ring>    unpack_ring_;
+
+    // frames are stored in image_.texture_array()
+    bool                          pack_layers_{false};
+
+
+
+    // uploads lines of target() to the texture of the current frame
+    void upload_lines(size_t, size_t);
+    void flush_strip();
+
+    void append_layer(frame&);
+    void stop_packing_layers(frame&);
+
+    [[nodiscard]] size_t frame_height() const;
 };
 
 }
@@ -0,0 +1,78 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_DETAILS_FUSED_CONVERSION_HPP_INCLUDED
+#define PIXGLOT_DETAILS_FUSED_CONVERSION_HPP_INCLUDED
+
+#include "pixglot/details/transfer-functions.hpp"
+#include "pixglot/pixel-buffer.hpp"
+#include "pixglot/pixel-format.hpp"
+#include "pixglot/square-isometry.hpp"
+
+#include <bit>
+#include <optional>
+
+namespace pixglot::details {
+
+// Orientation, endian, gamma, alpha, data format and color channel conversion of a
+// pixel_buffer in a single pass: every source pixel is read once in the order of the
+// rotated target, and every target pixel is written once.
+class fused_conversion {
+  public:
+    struct parameters {
+      pixel_format    source_format;
+      std::endian     source_endian{std::endian::native};
+      pixel_format    target_format;
+      std::endian     target_endian{std::endian::native};
+      int             premultiply{0};
+      gamma_transfer  gamma{};
+      square_isometry transform{square_isometry::identity};
+
+      [[nodiscard]] bool swap_source()      const;
+      [[nodiscard]] bool swap_target()      const;
+      [[nodiscard]] bool gamma_correction() const;
+    };
+
+    using kernel = void(const parameters&, const pixel_buffer&, pixel_buffer&);
+
+
+
+    fused_conversion(
+        pixel_format               source_format,
+        std::endian                source_endian,
+        pixel_format               target_format,
+        std::optional<std::endian> target_endian,
+        int                        premultiply,
+        gamma_transfer             gamma,
+        square_isometry            transform
+    );
+
+    [[nodiscard]] const parameters& params() const { return params_; }
+
+    [[nodiscard]] pixel_buffer apply(const pixel_buffer&) const;
+
+
+
+  private:
+    parameters params_;
+    kernel*    kernel_;
+};
+
+
+
+// The fused_conversion details::convert will use for any pixel_buffer of the given
+// source description, or std::nullopt if this depends on the size of the buffer or the
+// conversion is done in place.
+[[nodiscard]] std::optional<fused_conversion> select_fused_conversion(
+    pixel_format               source_format,
+    std::endian                source_endian,
+    pixel_format               target_format,
+    std::optional<std::endian> target_endian,
+    int                        premultiply,
+    gamma_transfer             gamma,
+    square_isometry            transform
+);
+
+}
+
+#endif // PIXGLOT_DETAILS_FUSED_CONVERSION_HPP_INCLUDED
@@ -0,0 +1,208 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_DETAILS_TRANSFER_FUNCTIONS_HPP_INCLUDED
+#define PIXGLOT_DETAILS_TRANSFER_FUNCTIONS_HPP_INCLUDED
+
+#include "pixglot/pixel-format.hpp"
+
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+
+
+
+// Vectorized approximations of pow and the sRGB transfer curves.
+// For normal inputs in [FLT_MIN, inf) the relative error of fast_pow is below
+// 1e-6 * (1 + |e * log2(x)|); all other inputs, including subnormals, fall back to
+// std::pow.
+namespace pixglot::details {
+  using f32x4 = f32 __attribute__((vector_size(16)));
+  using i32x4 = std::int32_t __attribute__((vector_size(16)));
+
+
+
+  [[nodiscard]] inline f32x4 broadcast(f32 value) {
+    return f32x4{} + value;
+  }
+
+
+
+  [[nodiscard]] inline f32x4 fast_log2(f32x4 x) {
+    auto bits     = std::bit_cast<i32x4>(x);
+    auto exponent = ((bits >> 23) & 0xff) - 127;
+    auto mantissa = std::bit_cast<f32x4>((bits & 0x007fffff) | 0x3f800000);
+
+    // move the mantissa into [sqrt(1/2), sqrt(2)) to keep t small
+    i32x4 large = mantissa > broadcast(1.41421356f);
+    mantissa    = large ? mantissa * 0.5f : mantissa;
+    exponent   -= large;
+
+    // log2(m) = 2/ln(2) * atanh(t) with t = (m - 1) / (m + 1), |t| < 0.172
+    auto t  = (mantissa - 1.f) / (mantissa + 1.f);
+    auto t2 = t * t;
+
+    auto series = 1.f + t2 * (1.f / 3.f + t2 * (1.f / 5.f + t2 * (1.f / 7.f + t2 * (1.f / 9.f))));
+
+    return __builtin_convertvector(exponent, f32x4) + (2.f / 0.69314718f) * t * series;
+  }
+
+
+
+  // 2^y is finite below 128, larger inputs return inf
+  [[nodiscard]] inline f32x4 fast_exp2(f32x4 y) {
+    i32x4 underflow = y < broadcast(-125.f);
+    i32x4 overflow  = y >= broadcast(128.f);
+
+    y = y < broadcast(-125.f) ? broadcast(-125.f) : y;
+    y = y > broadcast( 128.f) ? broadcast( 128.f) : y;
+
+    // round to nearest, so that the fractional part stays in [-0.5, 0.5]
+    auto half = y < broadcast(0.f) ? broadcast(-0.5f) : broadcast(0.5f);
+    auto n    = __builtin_convertvector(y + half, i32x4);
+    auto f = (y - __builtin_convertvector(n, f32x4)) * 0.69314718f;
+
+    auto p = 1.f + f * (1.f + f * (1.f / 2.f + f * (1.f / 6.f + f * (1.f / 24.f
+           + f * (1.f / 120.f + f * (1.f / 720.f + f * (1.f / 5040.f)))))));
+
+    // n = 128 does not fit the exponent field, move one factor 2 into p
+    i32x4 top = n > 127;
+    n += top;
+    p  = top ? p * 2.f : p;
+
+    auto result = std::bit_cast<f32x4>(std::bit_cast<i32x4>(p) + (n << 23));
+
+    result = underflow ? broadcast(0.f) : result;
+    return overflow ? broadcast(INFINITY) : result;
+  }
+
+
+
+  [[nodiscard]] inline f32x4 fast_pow(f32x4 x, f32 exp) {
+    auto result = fast_exp2(exp * fast_log2(x));
+
+    // fast_log2 reads the exponent field, which is wrong for subnormals
+    i32x4 regular = x >= broadcast(FLT_MIN) && x < broadcast(INFINITY);
+    for (int i = 0; i < 4; ++i) {
+      if (regular[i] == 0) {
+        result[i] = std::pow(x[i], exp);
+      }
+    }
+
+    return result;
+  }
+
+
+
+  [[nodiscard]] inline f32x4 srgb_to_linear(f32x4 x) {
+    auto curve = fast_pow((x + 0.055f) * (1.f / 1.055f), 2.4f);
+    return x <= broadcast(0.04045f) ? x * (1.f / 12.92f) : curve;
+  }
+
+
+
+  [[nodiscard]] inline f32x4 linear_to_srgb(f32x4 x) {
+    auto curve = 1.055f * fast_pow(x, 1.f / 2.4f) - 0.055f;
+    return x <= broadcast(0.0031308f) ? x * 12.92f : curve;
+  }
+
+
+
+  // Change of gamma applied to the color channels by details::convert, either a power
+  // law with the given exponent or one of the sRGB curves.
+  struct gamma_transfer {
+    enum class curve { power, srgb_to_linear, linear_to_srgb };
+
+    curve function{curve::power};
+    float exponent{1.f};
+
+    [[nodiscard]] static gamma_transfer power(float exp) {
+      return gamma_transfer{.function = curve::power, .exponent = exp};
+    }
+
+    // Frames with gamma_s_rgb hold sRGB encoded values, converting them from or to
+    // gamma_linear follows the sRGB curve; all other pairs use the power law
+    // source / target.
+    [[nodiscard]] static gamma_transfer between(float source, float target);
+
+    [[nodiscard]] bool identity() const {
+      return function == curve::power && exponent == 1.f;
+    }
+
+    [[nodiscard]] f32x4 apply(f32x4 x) const {
+      switch (function) {
+        case curve::srgb_to_linear: return srgb_to_linear(x);
+        case curve::linear_to_srgb: return linear_to_srgb(x);
+        case curve::power:          break;
+      }
+      return fast_pow(x, exponent);
+    }
+  };
+
+
+
+
+
+  // The same approximations for shaders, to be pasted after the #version directive
+  constexpr std::string_view glsl_transfer_functions = R"(
+float pixglot_log2(float x) {
+  int   e;
+  float m = frexp(x, e) * 2.0;
+  e -= 1;
+  if (m > 1.41421356) {
+    m *= 0.5;
+    e += 1;
+  }
+  float t  = (m - 1.0) / (m + 1.0);
+  float t2 = t * t;
+  float s  = 1.0 + t2 * (1.0/3.0 + t2 * (1.0/5.0 + t2 * (1.0/7.0 + t2 * (1.0/9.0))));
+  return float(e) + (2.0 / 0.69314718) * t * s;
+}
+
+float pixglot_exp2(float y) {
+  if (y < -125.0) { return 0.0; }
+  if (y >= 128.0) { return uintBitsToFloat(0x7f800000u); }
+  float n = round(y);
+  float f = (y - n) * 0.69314718;
+  float p = 1.0 + f * (1.0 + f * (1.0/2.0 + f * (1.0/6.0 + f * (1.0/24.0
+          + f * (1.0/120.0 + f * (1.0/720.0 + f * (1.0/5040.0)))))));
+  if (n > 127.0) {
+    n -= 1.0;
+    p *= 2.0;
+  }
+  return ldexp(p, int(n));
+}
+
+float pixglot_pow(float x, float e) {
+  if (x <= 0.0 || isinf(x)) { return pow(x, e); }
+  return pixglot_exp2(e * pixglot_log2(x));
+}
+
+vec4 pixglot_pow(vec4 x, vec4 e) {
+  return vec4(pixglot_pow(x.r, e.r), pixglot_pow(x.g, e.g),
+              pixglot_pow(x.b, e.b), pixglot_pow(x.a, e.a));
+}
+
+float pixglot_srgb_to_linear(float x) {
+  return x <= 0.04045 ? x / 12.92 : pixglot_pow((x + 0.055) / 1.055, 2.4);
+}
+
+float pixglot_linear_to_srgb(float x) {
+  return x <= 0.0031308 ? x * 12.92 : 1.055 * pixglot_pow(x, 1.0 / 2.4) - 0.055;
+}
+
+vec3 pixglot_srgb_to_linear(vec3 x) {
+  return vec3(pixglot_srgb_to_linear(x.r), pixglot_srgb_to_linear(x.g),
+              pixglot_srgb_to_linear(x.b));
+}
+
+vec3 pixglot_linear_to_srgb(vec3 x) {
+  return vec3(pixglot_linear_to_srgb(x.r), pixglot_linear_to_srgb(x.g),
+              pixglot_linear_to_srgb(x.b));
+}
+)";
+}
+
+#endif // PIXGLOT_DETAILS_TRANSFER_FUNCTIONS_HPP_INCLUDED
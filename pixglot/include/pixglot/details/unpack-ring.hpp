@@ -0,0 +1,74 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_DETAILS_UNPACK_RING_HPP_INCLUDED
+#define PIXGLOT_DETAILS_UNPACK_RING_HPP_INCLUDED
+
+#include "pixglot/details/hermit.hpp"
+
+#include <cstddef>
+#include <experimental/propagate_const>
+#include <memory>
+#include <span>
+
+
+
+namespace pixglot {
+  class gl_texture;
+  class pixel_buffer;
+}
+
+
+
+namespace pixglot::details {
+
+// Ring of persistently mapped GL_PIXEL_UNPACK_BUFFER slots. Texture updates read from
+// a slot asynchronously instead of stalling on client memory, a fence per slot
+// guards its reuse. Requires a current context for its whole lifetime.
+class unpack_ring : hermit {
+  public:
+    // true if the current context supports persistently mapped buffers
+    [[nodiscard]] static bool supported();
+
+    unpack_ring(size_t slot_size, size_t slot_count = 3);
+    ~unpack_ring();
+
+
+
+    struct slot {
+      std::span<std::byte> memory;
+      size_t               offset;
+    };
+
+    [[nodiscard]] size_t slot_size() const;
+
+    // Waits until GL no longer reads the next slot and binds the ring as
+    // GL_PIXEL_UNPACK_BUFFER, offset is the location of memory within the buffer.
+    [[nodiscard]] slot acquire();
+
+    // Fences all commands issued since acquire and unbinds the ring.
+    void release();
+
+
+
+  private:
+    class impl;
+    std::experimental::propagate_const<std::unique_ptr<impl>> impl_;
+};
+
+
+
+// Uploads h rows of source starting at source_y to the texture rows starting at y,
+// through ring if given.
+void upload_lines(
+    const gl_texture&   texture,
+    const pixel_buffer& source,
+    size_t              source_y,
+    size_t              y,
+    size_t              h,
+    unpack_ring*        ring = nullptr
+);
+
+}
+
+#endif // PIXGLOT_DETAILS_UNPACK_RING_HPP_INCLUDED
@@ -0,0 +1,67 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_DETAILS_YUV_COEFFICIENTS_HPP_INCLUDED
+#define PIXGLOT_DETAILS_YUV_COEFFICIENTS_HPP_INCLUDED
+
+#include "pixglot/yuv-buffer.hpp"
+
+#include <array>
+
+
+
+namespace pixglot::details {
+
+// r = y + cr_r * cr, g = y + cb_g * cb + cr_g * cr, b = y + cb_b * cb on samples in
+// [0, 255], where y = (Y - y_offset) * y_scale and c = (C - 128) * c_scale
+struct yuv_coefficients {
+  float y_offset;
+  float y_scale;
+  float c_scale;
+
+  float cr_r;
+  float cb_g;
+  float cr_g;
+  float cb_b;
+};
+
+
+
+[[nodiscard]] constexpr yuv_coefficients yuv_to_rgb(yuv_matrix matrix, bool full_range) {
+  float kr{0.299f};
+  float kb{0.114f};
+
+  switch (matrix) {
+    case yuv_matrix::bt601:  kr = 0.299f;  kb = 0.114f;  break;
+    case yuv_matrix::bt709:  kr = 0.2126f; kb = 0.0722f; break;
+    case yuv_matrix::bt2020: kr = 0.2627f; kb = 0.0593f; break;
+  }
+
+  float kg = 1.f - kr - kb;
+
+  return yuv_coefficients {
+    .y_offset = full_range ? 0.f : 16.f,
+    .y_scale  = full_range ? 1.f : 255.f / 219.f,
+    .c_scale  = full_range ? 1.f : 255.f / 224.f,
+
+    .cr_r     = 2.f * (1.f - kr),
+    .cb_g     = -2.f * kb * (1.f - kb) / kg,
+    .cr_g     = -2.f * kr * (1.f - kr) / kg,
+    .cb_b     = 2.f * (1.f - kb),
+  };
+}
+
+
+
+// row major matrix applied to (Y, Cb, Cr) - offset, including the range scaling
+[[nodiscard]] constexpr std::array<float, 9> yuv_to_rgb_matrix(const yuv_coefficients& c) {
+  return {
+    c.y_scale, 0.f,                 c.cr_r * c.c_scale,
+    c.y_scale, c.cb_g * c.c_scale,  c.cr_g * c.c_scale,
+    c.y_scale, c.cb_b * c.c_scale,  0.f,
+  };
+}
+
+}
+
+#endif // PIXGLOT_DETAILS_YUV_COEFFICIENTS_HPP_INCLUDED
@@ -5,11 +5,14 @@
 #define PIXGLOT_FRAME_HPP_INCLUDED
 
 #include "pixglot/gl-texture.hpp"
+#include "pixglot/indexed-buffer.hpp"
 #include "pixglot/pixel-buffer.hpp"
 #include "pixglot/square-isometry.hpp"
+#include "pixglot/yuv-buffer.hpp"
 
 #include <chrono>
 #include <functional>
+#include <optional>
 #include <string>
 #include <string_view>
 
@@ -33,6 +36,8 @@ enum class alpha_mode {
 
 
 
+// gamma_s_rgb marks sRGB encoded values: conversions between it and gamma_linear use the
+// exact sRGB curve, all other gamma changes a power law.
 static constexpr float gamma_s_rgb {2.2f};
 static constexpr float gamma_linear{1.f};
 
@@ -44,6 +49,10 @@ enum class storage_type {
   pixel_buffer = 0,
   gl_texture   = 1,
   no_pixels    = 2,
+  // palette indices, only produced by decoders when preferred
+  indexed      = 3,
+  // planar Y'CbCr, only produced by decoders when preferred
+  yuv          = 4,
 };
 
 [[nodiscard]] std::string_view stringify(storage_type);
@@ -56,6 +65,22 @@ enum class storage_type {
 
 
 
+// Rectangle in pixels, counted from the top left corner of the canvas.
+struct frame_region {
+  size_t x     {0};
+  size_t y     {0};
+  size_t width {0};
+  size_t height{0};
+
+  bool operator==(const frame_region&) const = default;
+};
+
+[[nodiscard]] std::string to_string(const frame_region&);
+
+
+
+
+
 class frame_source_info;
 class metadata;
 
@@ -74,8 +99,10 @@ class frame_view {
 
     [[nodiscard]] storage_type type() const;
 
-    [[nodiscard]] const gl_texture&   texture() const;
-    [[nodiscard]] const pixel_buffer& pixels()  const;
+    [[nodiscard]] const gl_texture&     texture() const;
+    [[nodiscard]] const pixel_buffer&   pixels()  const;
+    [[nodiscard]] const indexed_buffer& indexed() const;
+    [[nodiscard]] const yuv_buffer&     yuv()     const;
 
 
 
@@ -99,6 +126,10 @@ class frame_view {
           return std::invoke(std::forward<Fnc>(function), pixels());
         case storage_type::gl_texture:
           return std::invoke(std::forward<Fnc>(function), texture());
+        case storage_type::indexed:
+          return std::invoke(std::forward<Fnc>(function), indexed());
+        case storage_type::yuv:
+          return std::invoke(std::forward<Fnc>(function), yuv());
       }
     }
 
@@ -111,6 +142,15 @@ class frame_view {
 
     [[nodiscard]] std::optional<std::string_view> name() const;
 
+    // Set if the pixels are stored in this layer of image::texture_array(), the frame
+    // itself then has storage_type::no_pixels.
+    [[nodiscard]] std::optional<size_t>           layer() const;
+
+    // Part of the animation canvas which differs from the previous frame of the image.
+    // The frame either covers the whole canvas or exactly this region, unset if the
+    // codec does not know; see gl_canvas.
+    [[nodiscard]] std::optional<frame_region>     changed_region() const;
+
 
 
     [[nodiscard]] size_t id() const;
@@ -142,20 +182,28 @@ class frame : public frame_view  {
     frame(size_t, size_t, pixel_format = {});
     frame(pixel_buffer);
     frame(gl_texture);
+    frame(indexed_buffer);
+    frame(yuv_buffer);
 
 
 
     void reset(size_t, size_t, pixel_format = {});
     void reset(pixel_buffer);
     void reset(gl_texture);
+    void reset(indexed_buffer);
+    void reset(yuv_buffer);
 
 
 
     using frame_view::texture;
     using frame_view::pixels;
+    using frame_view::indexed;
+    using frame_view::yuv;
 
-    [[nodiscard]] gl_texture&   texture();
-    [[nodiscard]] pixel_buffer& pixels();
+    [[nodiscard]] gl_texture&     texture();
+    [[nodiscard]] pixel_buffer&   pixels();
+    [[nodiscard]] indexed_buffer& indexed();
+    [[nodiscard]] yuv_buffer&     yuv();
 
 
 
@@ -177,6 +225,10 @@ class frame : public frame_view  {
           return std::invoke(std::forward<Fnc>(function), pixels());
         case storage_type::gl_texture:
           return std::invoke(std::forward<Fnc>(function), texture());
+        case storage_type::indexed:
+          return std::invoke(std::forward<Fnc>(function), indexed());
+        case storage_type::yuv:
+          return std::invoke(std::forward<Fnc>(function), yuv());
       }
     }
 
@@ -188,6 +240,8 @@ class frame : public frame_view  {
     using frame_view::alpha_mode;
 
     using frame_view::name;
+    using frame_view::layer;
+    using frame_view::changed_region;
 
 
 
@@ -198,6 +252,12 @@ class frame : public frame_view  {
 
     void name(std::string);
     void clear_name();
+
+    void layer(size_t);
+    void clear_layer();
+
+    void changed_region(frame_region);
+    void clear_changed_region();
 };
 
 [[nodiscard]] std::string to_string(const frame&);
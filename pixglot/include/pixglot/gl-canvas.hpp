@@ -0,0 +1,50 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_GL_CANVAS_HPP_INCLUDED
+#define PIXGLOT_GL_CANVAS_HPP_INCLUDED
+
+#include "pixglot/frame.hpp"
+#include "pixglot/gl-texture.hpp"
+#include "pixglot/pixel-format.hpp"
+
+
+
+namespace pixglot {
+
+// Single texture which shows the frames of an animation one after another. During
+// playback only the frame_view::changed_region() of each frame is uploaded.
+class gl_canvas {
+  public:
+    // starts out transparent black, srgb as for gl_texture
+    gl_canvas(size_t, size_t, pixel_format = {}, bool srgb = false);
+
+
+
+    [[nodiscard]] const gl_texture& texture() const { return texture_; }
+
+    [[nodiscard]] pixel_format format() const { return texture_.format(); }
+    [[nodiscard]] size_t       width()  const { return texture_.width();  }
+    [[nodiscard]] size_t       height() const { return texture_.height(); }
+
+
+
+    // Uploads the whole frame, e.g. after seeking. Frames smaller than the canvas are
+    // placed at their changed_region.
+    void present(const frame_view&) const;
+
+    // Uploads only the changed_region, the frame must directly follow the last one
+    // presented in its image. Falls back to present if the region is unknown.
+    void present_next(const frame_view&) const;
+
+
+
+  private:
+    gl_texture texture_;
+
+    void present_region(const frame_view&, const frame_region&) const;
+};
+
+}
+
+#endif // PIXGLOT_GL_CANVAS_HPP_INCLUDED
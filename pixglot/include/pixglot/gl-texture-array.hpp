@@ -0,0 +1,109 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_GL_TEXTURE_ARRAY_HPP_INCLUDED
+#define PIXGLOT_GL_TEXTURE_ARRAY_HPP_INCLUDED
+
+#include "pixglot/pixel-format.hpp"
+
+#include <string>
+#include <utility>
+
+
+
+namespace pixglot {
+
+class gl_texture;
+class pixel_buffer;
+
+
+
+// GL_TEXTURE_2D_ARRAY whose layers share size and format, e.g. the frames of an
+// animation. Storage is immutable, resize_layers reallocates it.
+class gl_texture_array {
+  public:
+    gl_texture_array(size_t, size_t, size_t layers, pixel_format = {}, size_t levels = 1);
+
+
+
+    auto operator<=>(const gl_texture_array&) const = default;
+
+
+
+    [[nodiscard]] bool         empty()  const { return id_.id == 0; }
+    [[nodiscard]] operator     bool()   const { return !empty();    }
+
+    [[nodiscard]] pixel_format format() const { return format_; }
+    [[nodiscard]] size_t       width()  const { return width_;  }
+    [[nodiscard]] size_t       height() const { return height_; }
+    [[nodiscard]] size_t       layers() const { return layers_; }
+    [[nodiscard]] size_t       levels() const { return levels_; }
+
+    [[nodiscard]] unsigned int id()     const { return id_.id;  }
+
+    void bind() const;
+
+
+
+    void upload_layer(size_t, const pixel_buffer&) const;
+    // copies the first level of the texture on the gpu
+    void copy_layer  (size_t, const gl_texture&)   const;
+
+    [[nodiscard]] gl_texture layer_texture(size_t) const;
+
+    // keeps the first level of all layers which fit into the new size
+    void resize_layers(size_t);
+
+    // Fills all levels below the first one and enables trilinear filtering,
+    // reallocates the storage with a full chain if it has only a single level.
+    // Does nothing unless gl_texture::mipmap_capable(format()).
+    void generate_mipmaps();
+
+
+
+  private:
+    struct texture_id {
+      texture_id(const texture_id&) = delete;
+      texture_id& operator=(const texture_id&) = delete;
+
+      texture_id(texture_id&& rhs) noexcept :
+        id{std::exchange(rhs.id, 0)}
+      {}
+
+      texture_id& operator=(texture_id&& rhs) noexcept {
+        cleanup();
+        id = std::exchange(rhs.id, 0);
+        return *this;
+      }
+
+      ~texture_id() { cleanup(); }
+
+      explicit texture_id(unsigned int id = 0) : id{id} {}
+
+      auto operator<=>(const texture_id&) const = default;
+
+      void cleanup();
+
+      unsigned int id{0};
+    };
+
+
+
+    size_t       width_ {0};
+    size_t       height_{0};
+    size_t       layers_{0};
+    size_t       levels_{1};
+    pixel_format format_{};
+
+    texture_id   id_;
+
+    void copy_first_level(const texture_id&, size_t) const;
+};
+
+
+
+[[nodiscard]] std::string to_string(const gl_texture_array&);
+
+}
+
+#endif // PIXGLOT_GL_TEXTURE_ARRAY_HPP_INCLUDED
@@ -6,6 +6,8 @@
 
 #include "pixglot/pixel-format.hpp"
 
+#include <experimental/propagate_const>
+#include <memory>
 #include <utility>
 
 
@@ -14,11 +16,64 @@ namespace pixglot {
 
 class pixel_buffer;
 
+
+
+// Pending result of gl_texture::download_async. All members must be called with the
+// context of the texture current.
+class texture_readback {
+  public:
+    texture_readback(const texture_readback&) = delete;
+    texture_readback(texture_readback&&) noexcept;
+    texture_readback& operator=(const texture_readback&) = delete;
+    texture_readback& operator=(texture_readback&&) noexcept;
+
+    ~texture_readback();
+
+
+
+    // true if get will not block, throws base_exception on a moved-from readback
+    [[nodiscard]] bool ready() const;
+
+    // Waits for the transfer and returns its result, throws base_exception when
+    // called a second time or on a moved-from readback.
+    [[nodiscard]] pixel_buffer get();
+
+
+
+  private:
+    friend class gl_texture;
+
+    class impl;
+    std::experimental::propagate_const<std::unique_ptr<impl>> impl_;
+
+    explicit texture_readback(std::unique_ptr<impl>);
+};
+
+
+
 class gl_texture {
   public:
-    explicit gl_texture(const pixel_buffer&);
+    // Storage is immutable, levels is the number of mipmap levels to allocate.
+    // srgb stores u8 rgb(a) as GL_SRGB8(_ALPHA8), which is linearised on sampling.
+    explicit gl_texture(const pixel_buffer&, size_t levels = 1, bool srgb = false);
 
-    gl_texture(size_t, size_t, pixel_format = {});
+    gl_texture(size_t, size_t, pixel_format = {}, size_t levels = 1, bool srgb = false);
+
+    // number of levels of a full mipmap chain for the given dimensions
+    [[nodiscard]] static size_t max_levels(size_t, size_t);
+
+    [[nodiscard]] static constexpr bool srgb_capable(pixel_format format) {
+      return format.format == data_format::u8 &&
+        (format.channels == color_channels::rgb ||
+         format.channels == color_channels::rgba);
+    }
+
+    // GL_R*32UI cannot be filtered and GL_RGB32F cannot be rendered to, which both
+    // glGenerateMipmap requires
+    [[nodiscard]] static constexpr bool mipmap_capable(pixel_format format) {
+      return format.format != data_format::u32 &&
+        !(format.format == data_format::f32 && format.channels == color_channels::rgb);
+    }
 
 
 
@@ -32,6 +87,8 @@ class gl_texture {
     [[nodiscard]] pixel_format format() const { return format_; }
     [[nodiscard]] size_t       width()  const { return width_;  }
     [[nodiscard]] size_t       height() const { return height_; }
+    [[nodiscard]] size_t       levels() const { return levels_; }
+    [[nodiscard]] bool         srgb()   const { return srgb_;   }
 
     [[nodiscard]] unsigned int id()     const { return id_.id;  }
 
@@ -41,10 +98,22 @@ class gl_texture {
 
     [[nodiscard]] pixel_buffer download();
 
+    // Starts copying the texture into a pixel pack buffer without waiting for it.
+    [[nodiscard]] texture_readback download_async();
+
     void update();
 
     void upload_lines(const pixel_buffer&, size_t, size_t) const;
 
+    // Fills all levels below the first one and enables trilinear filtering,
+    // reallocates the storage with a full chain if it has only a single level.
+    // Does nothing unless mipmap_capable(format()).
+    void generate_mipmaps();
+
+    // Reallocates the storage with or without sRGB decoding and copies all levels on
+    // the gpu, the stored values remain the same.
+    void srgb(bool);
+
 
 
   private:
@@ -77,7 +146,9 @@ class gl_texture {
 
     size_t       width_ {0};
     size_t       height_{0};
+    size_t       levels_{1};
     pixel_format format_{};
+    bool         srgb_  {false};
 
     texture_id   id_;
 };
@@ -0,0 +1,217 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_IMAGE_VIEW_HPP_INCLUDED
+#define PIXGLOT_IMAGE_VIEW_HPP_INCLUDED
+
+#include "pixglot/exception.hpp"
+#include "pixglot/pixel-buffer.hpp"
+#include "pixglot/pixel-format.hpp"
+#include "pixglot/utils/cast.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+
+
+namespace pixglot {
+
+// Non-owning, strided 2d view of pixels of type P (or const P). The pixel format is
+// checked once on construction, all accesses afterwards are unchecked.
+template<typename P> requires pixel_type<std::remove_const_t<P>>
+class image_view {
+  public:
+    using value_type = P;
+    using byte_type  = typename utils::const_qualified_byte<P>::byte;
+
+
+
+    image_view() = default;
+
+    // stride is the byte distance from one row to the next and may be negative
+    image_view(byte_type* origin, size_t width, size_t height, ptrdiff_t stride) :
+      origin_{origin},
+      width_ {width},
+      height_{height},
+      stride_{stride}
+    {}
+
+    explicit image_view(pixel_buffer& buffer) requires (!std::is_const_v<P>) :
+      image_view{from_buffer(buffer)}
+    {}
+
+    explicit image_view(const pixel_buffer& buffer) requires (std::is_const_v<P>) :
+      image_view{from_buffer(buffer)}
+    {}
+
+
+
+    [[nodiscard]] operator image_view<const P>() const requires (!std::is_const_v<P>) {
+      return image_view<const P>{origin_, width_, height_, stride_};
+    }
+
+
+
+
+
+    [[nodiscard]] byte_type* origin() const { return origin_; }
+    [[nodiscard]] size_t     width()  const { return width_;  }
+    [[nodiscard]] size_t     height() const { return height_; }
+    [[nodiscard]] ptrdiff_t  stride() const { return stride_; }
+
+    [[nodiscard]] bool       empty()  const { return width_ == 0 || height_ == 0; }
+
+
+
+    [[nodiscard]] std::span<P> row(size_t y) const {
+      return {pixel_at(row_origin(y)), width_};
+    }
+
+    [[nodiscard]] P& operator[](size_t x, size_t y) const {
+      //NOLINTNEXTLINE(*-pointer-arithmetic)
+      return *pixel_at(row_origin(y) + x * sizeof(P));
+    }
+
+
+
+    // throws index_out_of_range if the rectangle does not fit into the view
+    [[nodiscard]] image_view subview(
+        size_t x,
+        size_t y,
+        size_t width,
+        size_t height
+    ) const {
+      if (x + width > width_) {
+        throw index_out_of_range{x + width, width_ + 1};
+      }
+      if (y + height > height_) {
+        throw index_out_of_range{y + height, height_ + 1};
+      }
+
+      if (width == 0 || height == 0) {
+        return image_view{nullptr, width, height, stride_};
+      }
+
+      //NOLINTNEXTLINE(*-pointer-arithmetic)
+      return image_view{row_origin(y) + x * sizeof(P), width, height, stride_};
+    }
+
+
+
+
+
+    template<typename Value>
+    class strided_iterator {
+      public:
+        using value_type      = Value;
+        using difference_type = ptrdiff_t;
+        using reference       = std::conditional_t<std::is_same_v<Value, std::span<P>>,
+                                                   std::span<P>, P&>;
+
+        strided_iterator() = default;
+
+        strided_iterator(byte_type* origin, ptrdiff_t stride, size_t index, size_t wid) :
+          origin_{origin}, stride_{stride}, index_{index}, width_{wid}
+        {}
+
+
+
+        [[nodiscard]] reference operator*() const {
+          //NOLINTNEXTLINE(*-pointer-arithmetic)
+          auto* location = origin_ + static_cast<ptrdiff_t>(index_) * stride_;
+
+          if constexpr (std::is_same_v<Value, std::span<P>>) {
+            return std::span<P>{pixel_at(location), width_};
+          } else {
+            return *pixel_at(location);
+          }
+        }
+
+
+
+        strided_iterator& operator++() {
+          ++index_;
+          return *this;
+        }
+
+        strided_iterator operator++(int) {
+          auto copy = *this;
+          ++index_;
+          return copy;
+        }
+
+
+
+        [[nodiscard]] bool operator==(const strided_iterator& rhs) const {
+          return index_ == rhs.index_;
+        }
+
+
+
+      private:
+        byte_type* origin_{nullptr};
+        ptrdiff_t  stride_{0};
+        size_t     index_ {0};
+        size_t     width_ {0};
+    };
+
+    using row_iterator    = strided_iterator<std::span<P>>;
+    using column_iterator = strided_iterator<std::remove_const_t<P>>;
+
+
+
+    [[nodiscard]] std::ranges::subrange<row_iterator> rows() const {
+      return {row_iterator{origin_, stride_, 0, width_},
+              row_iterator{origin_, stride_, height_, width_}};
+    }
+
+    [[nodiscard]] std::ranges::subrange<column_iterator> column(size_t x) const {
+      //NOLINTNEXTLINE(*-pointer-arithmetic)
+      auto* origin = origin_ + x * sizeof(P);
+      return {column_iterator{origin, stride_, 0, 1},
+              column_iterator{origin, stride_, height_, 1}};
+    }
+
+
+
+  private:
+    byte_type* origin_{nullptr};
+    size_t     width_ {0};
+    size_t     height_{0};
+    ptrdiff_t  stride_{0};
+
+
+
+    [[nodiscard]] byte_type* row_origin(size_t y) const {
+      //NOLINTNEXTLINE(*-pointer-arithmetic)
+      return origin_ + static_cast<ptrdiff_t>(y) * stride_;
+    }
+
+    [[nodiscard]] static P* pixel_at(byte_type* location) {
+      //NOLINTNEXTLINE(*reinterpret-cast)
+      return reinterpret_cast<P*>(location);
+    }
+
+
+
+    template<typename Buffer>
+    [[nodiscard]] static image_view from_buffer(Buffer& buffer) {
+      if (std::remove_const_t<P>::format() != buffer.format()) {
+        throw bad_pixel_format{std::remove_const_t<P>::format(), buffer.format()};
+      }
+
+      if (buffer.height() == 0) {
+        return image_view{nullptr, buffer.width(), 0, 0};
+      }
+
+      return image_view{buffer.row_bytes(0).data(), buffer.width(), buffer.height(),
+                        buffer.signed_stride()};
+    }
+};
+
+}
+
+#endif // PIXGLOT_IMAGE_VIEW_HPP_INCLUDED
@@ -5,9 +5,11 @@
 #define PIXGLOT_IMAGE_HPP_INCLUDED
 
 #include "pixglot/frame.hpp"
+#include "pixglot/gl-texture-array.hpp"
 
 #include <experimental/propagate_const>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
 
@@ -60,6 +62,10 @@ class image {
     [[nodiscard]] const pixglot::metadata&     metadata()      const;
     [[nodiscard]] pixglot::metadata&           metadata();
 
+    // holds the pixels of all frames with a layer(), see output_format::texture_array
+    [[nodiscard]] const std::optional<gl_texture_array>& texture_array() const;
+    [[nodiscard]]       std::optional<gl_texture_array>& texture_array();
+
 
 
     [[nodiscard]] std::string_view             mime_type()     const;
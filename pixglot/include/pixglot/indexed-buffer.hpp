@@ -0,0 +1,83 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_INDEXED_BUFFER_HPP_INCLUDED
+#define PIXGLOT_INDEXED_BUFFER_HPP_INCLUDED
+
+#include "pixglot/pixel-buffer.hpp"
+#include "pixglot/pixel-format.hpp"
+
+#include <array>
+#include <span>
+#include <string>
+
+
+
+namespace pixglot {
+
+// u8 indices into a palette of at most 256 colors. The pixel format describes the
+// colors the indices resolve to and is either rgb<u8> or rgba<u8>, in the former case
+// the alpha component of the palette entries is ignored.
+class indexed_buffer {
+  public:
+    static constexpr size_t max_palette_size = 256;
+
+
+
+    // throws base_exception if the palette has too many entries or channels is neither
+    // rgb nor rgba
+    indexed_buffer(
+        size_t                    width,
+        size_t                    height,
+        std::span<const rgba<u8>> palette,
+        color_channels            channels = color_channels::rgba
+    );
+
+
+
+    [[nodiscard]] pixel_format format() const { return {data_format::u8, channels_}; }
+    [[nodiscard]] size_t       width()  const { return indices_.width();  }
+    [[nodiscard]] size_t       height() const { return indices_.height(); }
+
+    [[nodiscard]] bool         empty()  const { return indices_.empty(); }
+
+
+
+    // gray<u8> buffer holding one palette index per pixel
+    [[nodiscard]] const pixel_buffer& indices() const { return indices_; }
+    [[nodiscard]]       pixel_buffer& indices()       { return indices_; }
+
+
+
+    [[nodiscard]] std::span<const rgba<u8>> palette() const {
+      return std::span{palette_}.first(palette_size_);
+    }
+
+    [[nodiscard]] std::span<rgba<u8>> palette() {
+      return std::span{palette_}.first(palette_size_);
+    }
+
+    // throws base_exception if the palette has too many entries
+    void palette(std::span<const rgba<u8>>);
+
+    // All 256 entries, indices beyond the palette resolve to transparent black.
+    [[nodiscard]] const std::array<rgba<u8>, max_palette_size>& lookup_table() const {
+      return palette_;
+    }
+
+
+
+  private:
+    pixel_buffer                           indices_;
+    std::array<rgba<u8>, max_palette_size> palette_{};
+    size_t                                 palette_size_{0};
+    color_channels                         channels_;
+};
+
+
+
+[[nodiscard]] std::string to_string(const indexed_buffer&);
+
+}
+
+#endif // PIXGLOT_INDEXED_BUFFER_HPP_INCLUDED
@@ -53,6 +53,20 @@ class output_format {
     [[nodiscard]] const preference<square_isometry      >& orientation()        const;
     [[nodiscard]]       preference<square_isometry      >& orientation();
 
+    [[nodiscard]] const preference<bool                 >& mipmaps()            const;
+    [[nodiscard]]       preference<bool                 >& mipmaps();
+
+    // Decode all frames of a gl_texture image into one GL_TEXTURE_2D_ARRAY, see
+    // image::texture_array. Falls back to a texture per frame if the frames differ in
+    // size or format.
+    [[nodiscard]] const preference<bool                 >& texture_array()      const;
+    [[nodiscard]]       preference<bool                 >& texture_array();
+
+    // Store gl_texture frames with u8 rgb(a) pixels and sRGB gamma as GL_SRGB8(_ALPHA8),
+    // so that sampling returns linear values without a conversion pass.
+    [[nodiscard]] const preference<bool                 >& srgb_texture()       const;
+    [[nodiscard]]       preference<bool                 >& srgb_texture();
+
 
 
     void storage_type      (preference<pixglot::storage_type>);
@@ -67,6 +81,10 @@ class output_format {
     void gamma             (preference<float>);
     void orientation       (preference<square_isometry>);
 
+    void mipmaps           (preference<bool>);
+    void texture_array     (preference<bool>);
+    void srgb_texture      (preference<bool>);
+
 
 
     void enforce();
@@ -9,6 +9,8 @@
 #include "pixglot/pixel-format.hpp"
 #include "pixglot/utils/cast.hpp"
 
+#include <cstddef>
+#include <memory>
 #include <string>
 
 
@@ -17,6 +19,15 @@ namespace pixglot {
 
 class pixel_buffer {
   public:
+    pixel_buffer(const pixel_buffer&);
+    pixel_buffer(pixel_buffer&&) noexcept = default;
+    pixel_buffer& operator=(const pixel_buffer&);
+    pixel_buffer& operator=(pixel_buffer&&) noexcept = default;
+
+    ~pixel_buffer() = default;
+
+
+
     static constexpr size_t alignment = 32;
 
     [[nodiscard]] static constexpr size_t padding() {
@@ -48,17 +59,49 @@ class pixel_buffer {
       height_{height},
       format_{format},
       endian_{endian},
+      stride_{stride_for_width(width_, format_)},
 
-      buffer_{height_ * stride_for_width(width_, format_) / sizeof(aligner)}
+      buffer_{std::make_shared<buffer<aligner>>(height_ * stride_ / sizeof(aligner))}
     {}
 
 
 
+    // Returns a buffer referencing a rectangle of this one without copying. Both share
+    // the allocation: writes to the pixels of either are visible in the other, while
+    // copies and conversions of either leave the other untouched.
+    [[nodiscard]] pixel_buffer sub_buffer(size_t x, size_t y, size_t width, size_t height);
+
+    // true if the allocation is shared with sub buffers or the buffer it was taken from
+    [[nodiscard]] bool shares_storage() const { return buffer_.use_count() > 1; }
+
+    // Moves the pixels to an allocation of their own if the storage is shared, called
+    // before modifying pixels in place.
+    void unshare();
+
+
 
-    [[nodiscard]] std::span<const std::byte> data()   const { return buffer_.as_bytes(); }
-    [[nodiscard]] std::span<std::byte>       data()         { return buffer_.as_bytes(); }
 
-    [[nodiscard]] bool                       empty()  const { return buffer_.empty(); }
+    // For sub buffers, the rows are interleaved with data of the parent buffer.
+    [[nodiscard]] std::span<const std::byte> data() const {
+      if (!buffer_) {
+        return {};
+      }
+      auto bytes = buffer_->as_bytes().subspan(offset_);
+      return bytes.first(std::min(bytes.size(), height_ * stride_));
+    }
+
+    [[nodiscard]] std::span<std::byte> data() {
+      if (!buffer_) {
+        return {};
+      }
+      auto bytes = buffer_->as_bytes().subspan(offset_);
+      return bytes.first(std::min(bytes.size(), height_ * stride_));
+    }
+
+
+    [[nodiscard]] bool                       empty()  const {
+      return !buffer_ || buffer_->empty();
+    }
     [[nodiscard]] operator                   bool()   const { return !empty();        }
 
     [[nodiscard]] pixel_format               format() const { return format_; }
@@ -66,19 +109,47 @@ class pixel_buffer {
     [[nodiscard]] size_t                     height() const { return height_; }
     [[nodiscard]] std::endian                endian() const { return endian_; }
 
+    // rows are stored from the bottom to the top of the image, data() starts with the
+    // last row
+    [[nodiscard]] bool                       bottom_up() const { return bottom_up_; }
+
 
 
     [[nodiscard]] size_t stride() const {
       if (height() != 0) {
-        return buffer_.byte_size() / height();
+        return stride_;
       }
       return 0;
     }
 
+    // byte distance from one row to the next, negative for bottom_up buffers
+    [[nodiscard]] ptrdiff_t signed_stride() const {
+      auto stride = static_cast<ptrdiff_t>(this->stride());
+      return bottom_up_ ? -stride : stride;
+    }
+
 
 
     void endian(std::endian endian) { endian_ = endian; }
 
+    // Only changes the interpretation of the row order, which flips the image vertically
+    // without touching the data.
+    void bottom_up(bool bottom_up) { bottom_up_ = bottom_up; }
+
+
+
+    // Changes the format while keeping the allocation, the stride shrinks to the one
+    // of the new format and the data is left as it is. For in-place conversions.
+    void reinterpret(pixel_format format) {
+      auto stride = stride_for_width(width_, format);
+      if (stride > stride_) {
+        throw bad_pixel_format{format, format_};
+      }
+
+      format_ = format;
+      stride_ = stride;
+    }
+
 
 
 
@@ -92,7 +163,7 @@ class pixel_buffer {
         throw bad_pixel_format{P::format(), format()};
       }
       return utils::interpret_as_n_unchecked<P>(
-          data().subspan(index * stride()), width());
+          data().subspan(row_offset(index)), width());
     }
 
 
@@ -106,7 +177,7 @@ class pixel_buffer {
         throw bad_pixel_format{P::format(), format()};
       }
       return utils::interpret_as_n_unchecked<const P>(
-          data().subspan(index * stride()), width());
+          data().subspan(row_offset(index)), width());
     }
 
 
@@ -118,7 +189,7 @@ class pixel_buffer {
       if (index >= height()) {
         throw index_out_of_range{index, height()};
       }
-      return data().subspan(index * stride(), width() * format().size());
+      return data().subspan(row_offset(index), width() * format().size());
     }
 
 
@@ -127,7 +198,7 @@ class pixel_buffer {
       if (index >= height()) {
         throw index_out_of_range{index, height()};
       }
-      return data().subspan(index * stride(), width() * format().size());
+      return data().subspan(row_offset(index), width() * format().size());
     }
 
 
@@ -144,14 +215,15 @@ class pixel_buffer {
         }
 
         [[nodiscard]] row_iterator end() {
-          return row_iterator{std::span{data.end(), 0}, stride, width};
+          return row_iterator{nullptr, stride, 0, width};
         }
 
 
 
         row_iterator& operator++() {
-          if (!data.empty()) {
-            data = data.subspan(stride);
+          if (remaining > 0 && --remaining > 0) {
+            //NOLINTNEXTLINE(*-pointer-arithmetic)
+            data += stride;
           }
 
           return *this;
@@ -160,8 +232,8 @@ class pixel_buffer {
 
 
         [[nodiscard]] bool operator==(const row_iterator& rhs) const {
-          return data.size() == rhs.data.size()
-            && data.data() == rhs.data.data()
+          return remaining == rhs.remaining
+            && (remaining == 0 || data == rhs.data)
             && stride == rhs.stride
             && width  == rhs.width;
         }
@@ -169,20 +241,22 @@ class pixel_buffer {
 
 
         [[nodiscard]] std::span<P> operator*() {
-          return utils::interpret_as_n_unchecked<P>(data, width);
+          return utils::interpret_as_n_unchecked<P>(
+              std::span{data, width * sizeof(P)}, width);
         }
 
 
 
       private:
-        std::span<std::byte> data;
-        size_t               stride;
-        size_t               width;
+        std::byte* data;
+        ptrdiff_t  stride;
+        size_t     remaining;
+        size_t     width;
 
 
 
-        row_iterator(std::span<std::byte> d, size_t str, size_t wid) :
-          data{d}, stride{str}, width{wid}
+        row_iterator(std::byte* d, ptrdiff_t str, size_t rem, size_t wid) :
+          data{d}, stride{str}, remaining{rem}, width{wid}
         {}
     };
 
@@ -193,7 +267,10 @@ class pixel_buffer {
       if (P::format() != format()) {
         throw bad_pixel_format{P::format(), format()};
       }
-      return row_iterator<P>{data(), stride(), width()};
+      if (height() == 0) {
+        return row_iterator<P>{nullptr, 0, 0, width()};
+      }
+      return row_iterator<P>{row_bytes(0).data(), signed_stride(), height(), width()};
     }
 
 
@@ -205,8 +282,17 @@ class pixel_buffer {
     pixel_format              format_{};
 
     std::endian               endian_{std::endian::native};
+    size_t                    stride_{0};
+    bool                      bottom_up_{false};
+
+    std::shared_ptr<buffer<aligner>> buffer_;
+    size_t                           offset_{0};
 
-    buffer<aligner>           buffer_;
+
+
+    [[nodiscard]] size_t row_offset(size_t index) const {
+      return (bottom_up_ ? height_ - 1 - index : index) * stride_;
+    }
 };
 
 [[nodiscard]] std::string to_string(const pixel_buffer&);
@@ -0,0 +1,119 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_TYPED_IMAGE_HPP_INCLUDED
+#define PIXGLOT_TYPED_IMAGE_HPP_INCLUDED
+
+#include "pixglot/exception.hpp"
+#include "pixglot/frame.hpp"
+#include "pixglot/image.hpp"
+#include "pixglot/image-view.hpp"
+#include "pixglot/output-format.hpp"
+#include "pixglot/pixel-format.hpp"
+
+#include <bit>
+#include <utility>
+
+
+
+namespace pixglot {
+
+template<pixel_type P>
+inline constexpr alpha_mode default_alpha_mode =
+  has_alpha(P::format().channels) ? alpha_mode::straight : alpha_mode::none;
+
+
+
+// An image whose frames are all pixel buffers of the compile-time format P with the
+// given endian and alpha mode.
+template<
+  pixel_type P,
+  std::endian         Endian = std::endian::native,
+  pixglot::alpha_mode Alpha  = default_alpha_mode<P>
+>
+class typed_image {
+  public:
+    using pixel = P;
+
+    static constexpr pixel_format        format     = P::format();
+    static constexpr std::endian         endian     = Endian;
+    static constexpr pixglot::alpha_mode alpha_mode = Alpha;
+
+
+
+    // Returns base with all properties fixed by the type required.
+    [[nodiscard]] static pixglot::output_format output_format(
+        pixglot::output_format base = {}
+    ) {
+      base.storage_type(storage_type::pixel_buffer);
+      base.data_format(format.format);
+      base.endian(Endian);
+
+      if (has_color(format.channels)) {
+        base.expand_gray_to_rgb(true);
+      }
+
+      if (has_alpha(format.channels)) {
+        base.fill_alpha(true);
+        base.alpha_mode(Alpha);
+      } else {
+        base.alpha_mode(pixglot::alpha_mode::straight);
+      }
+
+      return base;
+    }
+
+
+
+    // throws bad_pixel_format if any frame does not match the type
+    explicit typed_image(image&& img) :
+      image_{std::move(img)}
+    {
+      for (const auto& f: image_.frames()) {
+        if (f.type() != storage_type::pixel_buffer || f.format() != format) {
+          throw bad_pixel_format{format, f.format()};
+        }
+
+        if (byte_size(format.format) > 1 && f.pixels().endian() != Endian) {
+          throw base_exception{"Endian mismatch", "frame has unexpected endian"};
+        }
+
+        if (f.alpha_mode() != Alpha) {
+          throw base_exception{"Alpha mode mismatch", "frame has unexpected alpha mode"};
+        }
+      }
+    }
+
+
+
+    [[nodiscard]] const image& untyped() const { return image_; }
+    [[nodiscard]] image        release() &&    { return std::move(image_); }
+
+
+
+    [[nodiscard]] size_t size()  const { return image_.size();  }
+    [[nodiscard]] bool   empty() const { return image_.empty(); }
+
+    [[nodiscard]] const pixglot::frame& frame(size_t index = 0) const {
+      return image_.frame(index);
+    }
+
+
+
+    [[nodiscard]] image_view<const P> view(size_t index = 0) const {
+      return image_view<const P>{image_.frame(index).pixels()};
+    }
+
+    [[nodiscard]] image_view<P> view(size_t index = 0) {
+      return image_view<P>{image_.frame(index).pixels()};
+    }
+
+
+
+  private:
+    image image_;
+};
+
+}
+
+#endif // PIXGLOT_TYPED_IMAGE_HPP_INCLUDED
@@ -4,11 +4,14 @@
 #ifndef PIXGLOT_UTILS_GL_HPP_INCLUDED
 #define PIXGLOT_UTILS_GL_HPP_INCLUDED
 
+#include "pixglot/frame.hpp"
+#include "pixglot/gl-texture.hpp"
 #include "pixglot/pixel-buffer.hpp"
 #include "pixglot/pixel-format.hpp"
 #include "pixglot/utils/int_cast.hpp"
 
 #include <array>
+#include <optional>
 #include <stdexcept>
 
 #include <GL/gl.h>
@@ -19,29 +22,32 @@ namespace pixglot::utils {
 
 [[nodiscard]] constexpr pixel_format pixel_format_from_gl_internal(GLint fmt) {
   switch (fmt) {
-    case GL_R8:          return gray<u8>::format();
-    case GL_R16:         return gray<u16>::format();
-    case GL_R32UI:       return gray<u32>::format();
-    case GL_R16F:        return gray<f16>::format();
-    case GL_R32F:        return gray<f32>::format();
-
-    case GL_RG8:         return gray_a<u8>::format();
-    case GL_RG16:        return gray_a<u16>::format();
-    case GL_RG32UI:      return gray_a<u32>::format();
-    case GL_RG16F:       return gray_a<f16>::format();
-    case GL_RG32F:       return gray_a<f32>::format();
-
-    case GL_RGB8:        return rgb<u8>::format();
-    case GL_RGB16_SNORM: return rgb<u16>::format();
-    case GL_RGB32UI:     return rgb<u32>::format();
-    case GL_RGB16F:      return rgb<f16>::format();
-    case GL_RGB32F:      return rgb<f32>::format();
-
-    case GL_RGBA8:       return rgba<u8>::format();
-    case GL_RGBA16:      return rgba<u16>::format();
-    case GL_RGBA32UI:    return rgba<u32>::format();
-    case GL_RGBA16F:     return rgba<f16>::format();
-    case GL_RGBA32F:     return rgba<f32>::format();
+    case GL_R8:           return gray<u8>::format();
+    case GL_R16:          return gray<u16>::format();
+    case GL_R32UI:        return gray<u32>::format();
+    case GL_R16F:         return gray<f16>::format();
+    case GL_R32F:         return gray<f32>::format();
+
+    case GL_RG8:          return gray_a<u8>::format();
+    case GL_RG16:         return gray_a<u16>::format();
+    case GL_RG32UI:       return gray_a<u32>::format();
+    case GL_RG16F:        return gray_a<f16>::format();
+    case GL_RG32F:        return gray_a<f32>::format();
+
+    case GL_RGB8:         return rgb<u8>::format();
+    case GL_SRGB8:        return rgb<u8>::format();
+    case GL_RGB16:        return rgb<u16>::format();
+    case GL_RGB16_SNORM:  return rgb<u16>::format();
+    case GL_RGB32UI:      return rgb<u32>::format();
+    case GL_RGB16F:       return rgb<f16>::format();
+    case GL_RGB32F:       return rgb<f32>::format();
+
+    case GL_RGBA8:        return rgba<u8>::format();
+    case GL_SRGB8_ALPHA8: return rgba<u8>::format();
+    case GL_RGBA16:       return rgba<u16>::format();
+    case GL_RGBA32UI:     return rgba<u32>::format();
+    case GL_RGBA16F:      return rgba<f16>::format();
+    case GL_RGBA32F:      return rgba<f32>::format();
 
     default: break;
   }
@@ -51,7 +57,21 @@ namespace pixglot::utils {
 
 
 
-[[nodiscard]] constexpr GLint gl_internal_format(pixel_format pf) {
+[[nodiscard]] constexpr bool is_gl_srgb_internal(GLint fmt) {
+  return fmt == GL_SRGB8 || fmt == GL_SRGB8_ALPHA8;
+}
+
+
+
+// srgb selects GL_SRGB8(_ALPHA8), which the texture unit linearises when sampling
+[[nodiscard]] constexpr GLint gl_internal_format(pixel_format pf, bool srgb = false) {
+  if (srgb) {
+    if (!gl_texture::srgb_capable(pf)) {
+      throw bad_pixel_format(pf);
+    }
+    return pf.channels == color_channels::rgb ? GL_SRGB8 : GL_SRGB8_ALPHA8;
+  }
+
   switch (pf.channels) {
     case color_channels::gray:
       switch (pf.format) {
@@ -74,7 +94,7 @@ namespace pixglot::utils {
     case color_channels::rgb:
       switch (pf.format) {
         case data_format::u8:  return GL_RGB8;
-        case data_format::u16: return GL_RGB16_SNORM;
+        case data_format::u16: return GL_RGB16;
         case data_format::u32: return GL_RGB32UI;
         case data_format::f16: return GL_RGB16F;
         case data_format::f32: return GL_RGB32F;
@@ -123,7 +143,7 @@ namespace pixglot::utils {
 
 
 
-inline void gl_swizzle_mask(color_channels channels) {
+inline void gl_swizzle_mask(color_channels channels, GLenum target = GL_TEXTURE_2D) {
   static constexpr std::array<std::array<GLint, 4>, 3> swizzleMask {
     std::array<GLint, 4>{GL_ZERO, GL_ZERO, GL_ZERO, GL_ONE},
     std::array<GLint, 4>{GL_RED,  GL_RED,  GL_RED,  GL_ONE},
@@ -132,7 +152,7 @@ inline void gl_swizzle_mask(color_channels channels) {
 
   if (auto n = n_channels(channels); n < swizzleMask.size()) {
     //NOLINTNEXTLINE(*constant-array-index)
-    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask[n].data());
+    glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask[n].data());
   }
 }
 
@@ -155,6 +175,54 @@ inline void gl_swizzle_mask(color_channels channels) {
 }
 
 
+
+// Uploads region of the bound GL_TEXTURE_2D, or of slice layer of the bound
+// GL_TEXTURE_2D_ARRAY, from source starting at (source_x, source_y).
+// GL reads rows in increasing order only, bottom_up buffers are sent row by row.
+inline void gl_upload_rows(
+    const pixel_buffer&   source,
+    size_t                source_x,
+    size_t                source_y,
+    const frame_region&   region,
+    std::optional<size_t> layer = {}
+) {
+  glPixelStorei(GL_UNPACK_ALIGNMENT,   gl_unpack_alignment(source.stride()));
+  glPixelStorei(GL_UNPACK_ROW_LENGTH,  gl_pixels_per_stride(source));
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, int_cast<GLint>(source_x));
+
+  size_t rows = source.bottom_up() ? 1 : region.height;
+
+  for (size_t i = 0; i < region.height; i += rows) {
+    if (layer) {
+      glTexSubImage3D(
+        GL_TEXTURE_2D_ARRAY,
+        0,
+        int_cast<GLint>(region.x), int_cast<GLint>(region.y + i), int_cast<GLint>(*layer),
+        int_cast<GLsizei>(region.width),
+        int_cast<GLsizei>(rows),
+        1,
+        gl_format(source.format()),
+        gl_type(source.format()),
+        source.row_bytes(source_y + i).data()
+      );
+    } else {
+      glTexSubImage2D(
+        GL_TEXTURE_2D,
+        0,
+        int_cast<GLint>(region.x), int_cast<GLint>(region.y + i),
+        int_cast<GLsizei>(region.width),
+        int_cast<GLsizei>(rows),
+        gl_format(source.format()),
+        gl_type(source.format()),
+        source.row_bytes(source_y + i).data()
+      );
+    }
+  }
+
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+}
+
+
 }
 
 #endif // PIXGLOT_UTILS_GL_HPP_INCLUDED
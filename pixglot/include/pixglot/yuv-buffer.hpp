@@ -0,0 +1,88 @@
+// Copyright (c) 2023 wolmibo
+// SPDX-License-Identifier: MIT
+
+#ifndef PIXGLOT_YUV_BUFFER_HPP_INCLUDED
+#define PIXGLOT_YUV_BUFFER_HPP_INCLUDED
+
+#include "pixglot/frame-source-info.hpp"
+#include "pixglot/pixel-buffer.hpp"
+#include "pixglot/pixel-format.hpp"
+
+#include <string>
+#include <string_view>
+
+
+
+namespace pixglot {
+
+enum class yuv_matrix {
+  bt601,
+  bt709,
+  bt2020,
+};
+
+[[nodiscard]] std::string_view stringify(yuv_matrix);
+[[nodiscard]] std::string      to_string(yuv_matrix);
+
+
+
+// Planar Y'CbCr with 8 bit per sample, each plane is a gray<u8> buffer. Subsampled
+// chroma planes cover ceil(width / 2) columns (4:2:2 and 4:2:0) and ceil(height / 2)
+// rows (4:2:0), with samples centered between the luma samples. The pixel format
+// describes the colors after conversion, which is always rgb<u8>.
+class yuv_buffer {
+  public:
+    yuv_buffer(
+        size_t             width,
+        size_t             height,
+        chroma_subsampling subsampling,
+        yuv_matrix         matrix     = yuv_matrix::bt601,
+        bool               full_range = true
+    );
+
+
+
+    [[nodiscard]] static size_t chroma_width (size_t width,  chroma_subsampling);
+    [[nodiscard]] static size_t chroma_height(size_t height, chroma_subsampling);
+
+
+
+    [[nodiscard]] pixel_format format() const { return rgb<u8>::format(); }
+    [[nodiscard]] size_t       width()  const { return y_.width();  }
+    [[nodiscard]] size_t       height() const { return y_.height(); }
+
+    [[nodiscard]] bool         empty()  const { return y_.empty(); }
+
+    [[nodiscard]] chroma_subsampling subsampling() const { return subsampling_; }
+    [[nodiscard]] yuv_matrix         matrix()      const { return matrix_;      }
+    // false if luma covers [16, 235] and chroma [16, 240]
+    [[nodiscard]] bool               full_range()  const { return full_range_;  }
+
+
+
+    [[nodiscard]] const pixel_buffer& y() const { return y_; }
+    [[nodiscard]]       pixel_buffer& y()       { return y_; }
+    [[nodiscard]] const pixel_buffer& u() const { return u_; }
+    [[nodiscard]]       pixel_buffer& u()       { return u_; }
+    [[nodiscard]] const pixel_buffer& v() const { return v_; }
+    [[nodiscard]]       pixel_buffer& v()       { return v_; }
+
+
+
+  private:
+    pixel_buffer       y_;
+    pixel_buffer       u_;
+    pixel_buffer       v_;
+
+    chroma_subsampling subsampling_;
+    yuv_matrix         matrix_;
+    bool               full_range_;
+};
+
+
+
+[[nodiscard]] std::string to_string(const yuv_buffer&);
+
+}
+
+#endif // PIXGLOT_YUV_BUFFER_HPP_INCLUDED
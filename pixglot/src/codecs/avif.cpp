@@ -8,6 +8,12 @@
 #include "pixglot/metadata.hpp"
 #include "pixglot/utils/cast.hpp"
 #include "pixglot/utils/int_cast.hpp"
+#include "pixglot/yuv-buffer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <span>
 
 #include <avif/avif.h>
 
@@ -238,6 +244,67 @@ namespace {
 
 
 
+  [[nodiscard]] std::optional<yuv_matrix> matrix_from(avifMatrixCoefficients coeffs) {
+    switch (coeffs) {
+      case AVIF_MATRIX_COEFFICIENTS_BT709:
+        return yuv_matrix::bt709;
+      case AVIF_MATRIX_COEFFICIENTS_UNSPECIFIED:
+      case AVIF_MATRIX_COEFFICIENTS_BT470BG:
+      case AVIF_MATRIX_COEFFICIENTS_BT601:
+        return yuv_matrix::bt601;
+      case AVIF_MATRIX_COEFFICIENTS_BT2020_NCL:
+        return yuv_matrix::bt2020;
+      default:
+        return {};
+    }
+  }
+
+
+
+  // the planes of the image if they can be stored as yuv_buffer without conversion
+  [[nodiscard]] std::optional<yuv_buffer> planar_buffer(avifImage* image) {
+    if (image->depth != 8 || image->alphaPlane != nullptr) {
+      return {};
+    }
+
+    auto matrix = matrix_from(image->matrixCoefficients);
+    if (!matrix) {
+      return {};
+    }
+
+    chroma_subsampling subsampling{};
+    switch (image->yuvFormat) {
+      case AVIF_PIXEL_FORMAT_YUV444: subsampling = chroma_subsampling::cs444; break;
+      case AVIF_PIXEL_FORMAT_YUV422: subsampling = chroma_subsampling::cs422; break;
+      case AVIF_PIXEL_FORMAT_YUV420: subsampling = chroma_subsampling::cs420; break;
+      default:
+        return {};
+    }
+
+    return yuv_buffer{image->width, image->height, subsampling, *matrix,
+                      image->yuvRange == AVIF_RANGE_FULL};
+  }
+
+
+
+  void copy_planes(const avifImage* image, yuv_buffer& yuv) {
+    std::array<pixel_buffer*, 3> planes{&yuv.y(), &yuv.u(), &yuv.v()};
+
+    for (size_t c = 0; c < planes.size(); ++c) {
+      auto& plane = *planes.at(c);
+
+      for (size_t y = 0; y < plane.height(); ++y) {
+        //NOLINTBEGIN(*-pointer-arithmetic,*-constant-array-index)
+        const auto* row = image->yuvPlanes[c] + y * image->yuvRowBytes[c];
+        //NOLINTEND(*-pointer-arithmetic,*-constant-array-index)
+        std::ranges::copy(std::as_bytes(std::span{row, plane.width()}),
+                          plane.row_bytes(y).begin());
+      }
+    }
+  }
+
+
+
   [[nodiscard]] square_isometry get_rotation(avifImage* image) {
     if ((image->transformFlags & AVIF_TRANSFORM_IROT) != 0) {
       switch (image->irot.angle % 4) {
@@ -311,7 +378,17 @@ namespace {
 
           avif_rgb_image rgb{dec_->image, decoder_->output_format()};
 
-          auto& frame = rgb.begin_frame(decoder_);
+          std::optional<yuv_buffer> planar;
+          if (decoder_->wants_yuv()) {
+            planar = planar_buffer(dec_->image);
+          }
+
+          auto& frame = planar ?
+            decoder_->begin_frame(std::move(*planar)) :
+            rgb.begin_frame(decoder_);
+          if (frame.type() == storage_type::yuv) {
+            frame.alpha_mode(alpha_mode::none);
+          }
           set_frame_source_info(frame.source_info(), dec_->image);
           frame.orientation(isometry_from(dec_->image));
           frame.duration   (std::chrono::microseconds{
@@ -322,10 +399,14 @@ namespace {
           if (decoder_->wants_pixel_transfer()) {
             decoder_->begin_pixel_transfer();
 
-            rgb.set_pixel_buffer(decoder_->target());
+            if (frame.type() == storage_type::yuv) {
+              copy_planes(dec_->image, frame.yuv());
+            } else {
+              rgb.set_pixel_buffer(decoder_->target());
 
-            assert_avif(avifImageYUVToRGB(dec_->image, rgb.get()),
-              "avifImageYUVToRGB");
+              assert_avif(avifImageYUVToRGB(dec_->image, rgb.get()),
+                "avifImageYUVToRGB");
+            }
 
             decoder_->finish_pixel_transfer();
           }
@@ -323,18 +323,32 @@ namespace {
 
 
 
-  [[nodiscard]] Slice create_slice(pixel_buffer& buffer, size_t index, float fill) {
+  // OpenEXR addresses pixels by their absolute coordinates inside the data window,
+  // the base pointer is therefore shifted by the window origin
+  [[nodiscard]] Slice create_slice(
+      pixel_buffer& buffer,
+      const Box2i&  data_window,
+      size_t        index,
+      float         fill
+  ) {
     if (index >= n_channels(buffer.format().channels)) {
       throw decode_error{codec::exr, "color channel index out of bounds"};
     }
 
-    size_t offset{index * byte_size(buffer.format().format)};
+    auto x_stride = utils::int_cast<ptrdiff_t>(buffer.format().size());
+    auto y_stride = buffer.signed_stride();
+
+    //NOLINTNEXTLINE(*reinterpret-cast)
+    auto base = reinterpret_cast<intptr_t>(buffer.row_bytes(0).data())
+      + utils::int_cast<ptrdiff_t>(index * byte_size(buffer.format().format))
+      - data_window.min.x * x_stride - data_window.min.y * y_stride;
 
     return Slice{
       convert_data_format(buffer.format().format),
-      utils::byte_pointer_cast<char>(buffer.data().subspan(offset).data()),
-      buffer.format().size(),
-      buffer.stride(),
+      //NOLINTNEXTLINE(*reinterpret-cast,*-no-int-to-ptr)
+      reinterpret_cast<char*>(base),
+      utils::int_cast<size_t>(x_stride),
+      static_cast<size_t>(y_stride),
       1, 1,
       fill
     };
@@ -557,15 +571,16 @@ namespace {
         std::optional<string> non_existing_channel;
 
         if (std::holds_alternative<const Channel*>(frame_source.second)) {
-          frame_buffer.insert(frame_source.first, create_slice(target, 0, 0.f));
+          frame_buffer.insert(frame_source.first,
+              create_slice(target, data_window_, 0, 0.f));
 
           size_t next_index{1};
 
           if (has_color(target.format().channels)) {
             frame_buffer.insert(frame_source.first,
-                create_slice(target, next_index++, 0.f));
+                create_slice(target, data_window_, next_index++, 0.f));
             frame_buffer.insert(frame_source.first,
-                create_slice(target, next_index++, 0.f));
+                create_slice(target, data_window_, next_index++, 0.f));
           }
 
           if (has_alpha(target.format().channels)) {
@@ -575,7 +590,7 @@ namespace {
             }
 
             frame_buffer.insert(*non_existing_channel,
-                create_slice(target, next_index++, 1.f));
+                create_slice(target, data_window_, next_index++, 1.f));
           }
 
         } else {
@@ -586,12 +601,13 @@ namespace {
           std::string cname = frame_source.first;
           cname.pop_back();
 
-          frame_buffer.insert((cname + 'R'), create_slice(target, 0, 0.f));
-          frame_buffer.insert((cname + 'G'), create_slice(target, 1, 0.f));
-          frame_buffer.insert((cname + 'B'), create_slice(target, 2, 0.f));
+          frame_buffer.insert((cname + 'R'), create_slice(target, data_window_, 0, 0.f));
+          frame_buffer.insert((cname + 'G'), create_slice(target, data_window_, 1, 0.f));
+          frame_buffer.insert((cname + 'B'), create_slice(target, data_window_, 2, 0.f));
 
           if (has_alpha(target.format().channels)) {
-            frame_buffer.insert((cname + 'A'), create_slice(target, 3, 1.f));
+            frame_buffer.insert((cname + 'A'),
+                create_slice(target, data_window_, 3, 1.f));
           }
         }
 
@@ -5,10 +5,14 @@
 #include "pixglot/details/xmp.hpp"
 #include "pixglot/frame.hpp"
 #include "pixglot/frame-source-info.hpp"
+#include "pixglot/image-view.hpp"
 #include "pixglot/metadata.hpp"
 #include "pixglot/utils/int_cast.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <optional>
+#include <vector>
 
 #include <gif_lib.h>
 
@@ -295,57 +299,106 @@ namespace {
       x{saturating_cast(desc.Left)}, y{saturating_cast(desc.Top)},
       width {saturating_cast(desc.Width)}, height{saturating_cast(desc.Height)}
     {}
+
+    [[nodiscard]] frame_region region() const {
+      return frame_region{.x = x, .y = y, .width = width, .height = height};
+    }
   };
 
 
 
+  [[nodiscard]] frame_region bounding_region(
+      const frame_region& a,
+      const frame_region& b
+  ) {
+    if (a.width == 0 || a.height == 0) {
+      return b;
+    }
+    if (b.width == 0 || b.height == 0) {
+      return a;
+    }
+
+    size_t x = std::min(a.x, b.x);
+    size_t y = std::min(a.y, b.y);
+
+    return frame_region{
+      .x      = x,
+      .y      = y,
+      .width  = std::max(a.x + a.width,  b.x + b.width)  - x,
+      .height = std::max(a.y + a.height, b.y + b.height) - y
+    };
+  }
+
+
 
 
+
+  // resolve maps an index to the pixel to draw or std::nullopt for transparent ones
+  template<pixel_type P, typename Resolve>
   void transfer_pixels_over_background(
       details::decoder&   decoder,
       const SavedImage&   img,
-      const gif_palette&  palette,
+      const Resolve&      resolve,
       const pixel_buffer& background
   ) {
     gif_rect rect{img.ImageDesc};
     auto source = std::span{img.RasterBits, rect.width * rect.height};
 
-    for (size_t y = 0; y < rect.y; ++y) {
-      std::ranges::copy(background.row_bytes(y), decoder.target().row_bytes(y).begin());
-      decoder.frame_mark_ready_until_line(y);
-    }
+    image_view<P>       target{decoder.target()};
+    image_view<const P> old   {background};
 
+    auto target_rect = target.subview(rect.x, rect.y, rect.width, rect.height);
 
 
-    for (size_t y = rect.y; y < rect.y + rect.height; ++y) {
-      auto row = decoder.target().row<rgba<u8>>(y);
-      auto old = background.row<rgba<u8>>(y);
 
+    for (size_t y = 0; y < target.height(); ++y) {
+      std::ranges::copy(old.row(y), target.row(y).begin());
 
-      auto it = std::copy_n(old.begin(), rect.x, row.begin());
+      if (y >= rect.y && y < rect.y + rect.height) {
+        auto row     = target_rect.row(y - rect.y);
+        auto indices = source.subspan((y - rect.y) * rect.width, rect.width);
 
-      auto jt = old.begin() + utils::int_cast<long>(rect.x);
-      for (auto in: source.subspan((y - rect.y) * rect.width, rect.width)) {
-        *it = palette.resolve_color(in);
-        if (it->a != 0xff) {
-          *it = *jt;
+        for (size_t x = 0; x < rect.width; ++x) {
+          if (auto pixel = resolve(indices[x])) {
+            row[x] = *pixel;
+          }
         }
-
-        ++it; ++jt;
       }
 
-      std::copy(jt, old.end(), it);
-
       decoder.frame_mark_ready_until_line(y);
     }
+  }
 
 
 
-    for (size_t y = rect.y + rect.height; y < decoder.target().height(); ++y) {
-      std::ranges::copy(background.row_bytes(y), decoder.target().row_bytes(y).begin());
-      decoder.frame_mark_ready_until_line(y);
-    }
-  }
+
+
+  // Indices into the global color map, which all frames share in indexed mode.
+  class gif_index_resolver {
+    public:
+      gif_index_resolver(size_t color_count, std::optional<size_t> alpha_index) :
+        color_count_{color_count},
+        alpha_index_{alpha_index}
+      {}
+
+
+
+      [[nodiscard]] std::optional<gray<u8>> operator()(u8 index) const {
+        if (index >= color_count_) {
+          throw decode_error{codec::gif, "palette index out of range"};
+        }
+        if (alpha_index_ && *alpha_index_ == index) {
+          return {};
+        }
+        return gray<u8>{index};
+      }
+
+
+
+    private:
+      size_t                color_count_;
+      std::optional<size_t> alpha_index_;
+  };
 
 
 
@@ -397,6 +450,10 @@ namespace {
       void decode() {
         fill_global_metadata();
 
+        if (decoder_->wants_indexed()) {
+          indexed_palette_ = global_indexed_palette();
+        }
+
         for (int i = 0; i < gif_->ImageCount; ++i) {
           decode_frame(gif_->SavedImages[i]); //NOLINT(*pointer-arithmetic)
         }
@@ -413,15 +470,22 @@ namespace {
 
       std::optional<pixel_buffer> background;
 
+      // unset before the first frame, the area restored by the last disposal otherwise
+      std::optional<frame_region> disposed_region_;
+
+      std::optional<std::vector<rgba<u8>>> indexed_palette_;
+      u8                                   background_index_{0};
+
 
 
       void decode_frame(const SavedImage& img) {
         assert_frame_size(img);
 
         gif_meta meta{img};
-        gif_palette palette{current_color_map(img), meta.alpha(), gif_->SBackGroundColor};
 
-        auto& frame = decoder_->begin_frame(width_, height_, rgba<u8>::format());
+        auto& frame = indexed_palette_ ?
+          decoder_->begin_frame(indexed_buffer{width_, height_, *indexed_palette_}) :
+          decoder_->begin_frame(width_, height_, rgba<u8>::format());
 
         frame.source_info().color_model(color_model::palette);
         frame.source_info().color_model_format({
@@ -434,6 +498,8 @@ namespace {
         frame.alpha_mode(get_preferred_alpha_mode());
         frame.duration  (meta.duration());
 
+        frame.changed_region(advance_changed_region(img, meta.dispose_mode()));
+
 
         fill_block_metadata(frame.metadata(),
             {img.ExtensionBlocks, saturating_cast(img.ExtensionBlockCount)});
@@ -442,34 +508,122 @@ namespace {
         if (decoder_->wants_pixel_transfer()) {
           decoder_->begin_pixel_transfer();
 
-          if (!background) {
-            background.emplace(width_, height_, rgba<u8>::format());
-            for (size_t y = 0; y < background->height(); ++y) {
-              std::ranges::fill(background->row<rgba<u8>>(y), palette.background());
-            }
+          if (indexed_palette_) {
+            compose(img, meta.dispose_mode(),
+                gif_index_resolver{saturating_cast(gif_->SColorMap->ColorCount),
+                                   meta.alpha()},
+                gray<u8>{background_index_});
+          } else {
+            gif_palette palette{current_color_map(img), meta.alpha(),
+                                gif_->SBackGroundColor};
+
+            compose(img, meta.dispose_mode(),
+                [&palette](u8 index) -> std::optional<rgba<u8>> {
+                  if (auto color = palette.resolve_color(index); color.a == 0xff) {
+                    return color;
+                  }
+                  return {};
+                },
+                palette.background());
           }
 
-          transfer_pixels_over_background(*decoder_, img, palette, *background);
+          decoder_->finish_pixel_transfer();
+        }
 
-          switch (meta.dispose_mode()) {
-            case dispose::background: {
-              gif_rect rect{img.ImageDesc};
-              for (size_t y = 0; y < rect.y + rect.height; ++y) {
-                auto row = background->row<rgba<u8>>(y).subspan(rect.x, rect.width);
-                std::ranges::fill(row, palette.background());
-              }
-            } break;
-            case dispose::previous:
-              break;
-            case dispose::leave_in_place:
-              background = decoder_->target();
-              break;
+        decoder_->finish_frame();
+      }
+
+
+
+      template<pixel_type P, typename Resolve>
+      void compose(
+          const SavedImage& img,
+          dispose           dispose_mode,
+          const Resolve&    resolve,
+          P                 background_pixel
+      ) {
+        if (!background) {
+          background.emplace(width_, height_, P::format());
+          for (auto row: image_view<P>{*background}.rows()) {
+            std::ranges::fill(row, background_pixel);
           }
+        }
 
-          decoder_->finish_pixel_transfer();
+        transfer_pixels_over_background<P>(*decoder_, img, resolve, *background);
+
+        switch (dispose_mode) {
+          case dispose::background: {
+            gif_rect rect{img.ImageDesc};
+            auto area = image_view<P>{*background}
+                          .subview(rect.x, rect.y, rect.width, rect.height);
+            for (auto row: area.rows()) {
+              std::ranges::fill(row, background_pixel);
+            }
+          } break;
+          case dispose::previous:
+            break;
+          case dispose::leave_in_place:
+            background = decoder_->target();
+            break;
         }
+      }
 
-        decoder_->finish_frame();
+
+
+      // Outside of its rectangle a frame shows the disposed canvas of its predecessor,
+      // which differs from the previous frame where that one was disposed.
+      [[nodiscard]] frame_region advance_changed_region(
+          const SavedImage& img,
+          dispose           dispose_mode
+      ) {
+        auto rect = gif_rect{img.ImageDesc}.region();
+
+        auto changed = disposed_region_ ?
+          bounding_region(rect, *disposed_region_) :
+          frame_region{.x = 0, .y = 0, .width = width_, .height = height_};
+
+        disposed_region_ = dispose_mode == dispose::leave_in_place ?
+          frame_region{} : rect;
+
+        return changed;
+      }
+
+
+
+      // Frames share one palette only if none brings its own color map. A transparent
+      // entry is appended for the background if it does not refer to a color.
+      [[nodiscard]] std::optional<std::vector<rgba<u8>>> global_indexed_palette() {
+        if (gif_->SColorMap == nullptr || gif_->SColorMap->ColorCount < 0) {
+          return {};
+        }
+
+        for (const auto& img: std::span{gif_->SavedImages,
+                                        saturating_cast(gif_->ImageCount)}) {
+          if (img.ImageDesc.ColorMap != nullptr) {
+            return {};
+          }
+        }
+
+        auto color_count = utils::int_cast<size_t>(gif_->SColorMap->ColorCount);
+        bool has_background = gif_->SBackGroundColor >= 0 &&
+          utils::int_cast<size_t>(gif_->SBackGroundColor) < color_count;
+
+        if (color_count + (has_background ? 0 : 1) > indexed_buffer::max_palette_size) {
+          return {};
+        }
+
+        std::vector<rgba<u8>> palette(color_count);
+        std::ranges::transform(std::span{gif_->SColorMap->Colors, color_count},
+            palette.begin(), convert_gif_color);
+
+        if (has_background) {
+          background_index_ = utils::int_cast<u8>(gif_->SBackGroundColor);
+        } else {
+          background_index_ = utils::int_cast<u8>(color_count);
+          palette.emplace_back(rgba<u8>{.r = 0, .g = 0, .b = 0, .a = 0});
+        }
+
+        return palette;
       }
 
 
@@ -12,8 +12,13 @@
 #include "pixglot/pixel-format.hpp"
 #include "pixglot/square-isometry.hpp"
 #include "pixglot/utils/cast.hpp"
+#include "pixglot/utils/int_cast.hpp"
+#include "pixglot/yuv-buffer.hpp"
 
+#include <algorithm>
+#include <array>
 #include <bit>
+#include <optional>
 #include <vector>
 
 #include <jpeglib.h>
@@ -247,8 +252,11 @@ namespace {
 
         decoder_->image().metadata().append_move(metadata_from_JFIF(cinfo_.get()));
 
-        auto& frame = decoder_->begin_frame(cinfo_->image_width, cinfo_->image_height,
-                                            pf);
+        auto subsampling = raw_subsampling();
+
+        auto& frame = subsampling ?
+          begin_raw_frame(*subsampling) :
+          decoder_->begin_frame(cinfo_->image_width, cinfo_->image_height, pf);
 
         frame.alpha_mode (alpha_mode::none);
         frame.orientation(orientation_);
@@ -256,10 +264,18 @@ namespace {
         set_frame_source_info(frame.source_info());
 
         if (decoder_->wants_pixel_transfer()) {
-          decoder_->begin_pixel_transfer();
+          if (subsampling) {
+            decoder_->begin_pixel_transfer();
+          } else {
+            decoder_->begin_strip_transfer();
+          }
 
           jpeg_start_decompress(cinfo_.get());
-          transfer_data(decoder_->target());
+          if (subsampling) {
+            transfer_raw_data(frame.yuv());
+          } else {
+            transfer_data();
+          }
           jpeg_finish_decompress(cinfo_.get());
 
           decoder_->finish_pixel_transfer();
@@ -294,17 +310,20 @@ namespace {
 
 
 
-      void transfer_data(pixel_buffer& pixbuf) {
-        uint32_t row_count = cinfo_->rec_outbuf_height;
-        std::vector<JSAMPROW> rows{row_count};
+      void transfer_data() {
+        std::vector<JSAMPROW> rows(cinfo_->rec_outbuf_height);
 
         while (cinfo_->output_scanline < cinfo_->output_height) {
-          for (uint32_t y = 0; y < row_count; ++y) {
+          size_t scanline  = cinfo_->output_scanline;
+          size_t row_count = std::min(rows.size(), decoder_->target_rows_from(scanline));
+
+          for (size_t y = 0; y < row_count; ++y) {
             rows[y] = utils::byte_pointer_cast<std::remove_pointer_t<JSAMPROW>>(
-              pixbuf.row_bytes(y + cinfo_->output_scanline).data());
+              decoder_->target_row(scanline + y).data());
           }
 
-          jpeg_read_scanlines(cinfo_.get(), rows.data(), row_count);
+          jpeg_read_scanlines(cinfo_.get(), rows.data(),
+                              utils::int_cast<JDIMENSION>(row_count));
 
           decoder_->frame_mark_ready_until_line(cinfo_->output_scanline);
         }
@@ -312,6 +331,103 @@ namespace {
 
 
 
+      // chroma subsampling if the planes can be stored as yuv_buffer without resampling
+      [[nodiscard]] std::optional<chroma_subsampling> raw_subsampling() const {
+        if (!decoder_->wants_yuv() ||
+            cinfo_->jpeg_color_space != JCS_YCbCr ||
+            cinfo_->num_components != 3 ||
+            cinfo_->data_precision != 8) {
+          return {};
+        }
+
+        //NOLINTBEGIN(*-pointer-arithmetic)
+        const auto* components = cinfo_->comp_info;
+        for (int c = 1; c < 3; ++c) {
+          if (components[c].h_samp_factor != 1 || components[c].v_samp_factor != 1) {
+            return {};
+          }
+        }
+
+        auto x = components[0].h_samp_factor;
+        auto y = components[0].v_samp_factor;
+        //NOLINTEND(*-pointer-arithmetic)
+
+        if (x == 1 && y == 1) {
+          return chroma_subsampling::cs444;
+        }
+        if (x == 2 && y == 1) {
+          return chroma_subsampling::cs422;
+        }
+        if (x == 2 && y == 2) {
+          return chroma_subsampling::cs420;
+        }
+        return {};
+      }
+
+
+
+      frame& begin_raw_frame(chroma_subsampling subsampling) {
+        cinfo_->out_color_space     = JCS_YCbCr;
+        cinfo_->raw_data_out        = TRUE;
+        cinfo_->do_fancy_upsampling = FALSE;
+
+        // JFIF mandates full range bt601
+        return decoder_->begin_frame(yuv_buffer{cinfo_->image_width,
+            cinfo_->image_height, subsampling, yuv_matrix::bt601, true});
+      }
+
+
+
+      // jpeg_read_raw_data returns whole iMCU rows, the planes receive the part inside
+      // the image
+      void transfer_raw_data(yuv_buffer& yuv) {
+        std::array<pixel_buffer*, 3> planes{&yuv.y(), &yuv.u(), &yuv.v()};
+
+        std::array<std::vector<JSAMPLE>,  3> samples;
+        std::array<std::vector<JSAMPROW>, 3> rows;
+        std::array<JSAMPARRAY,            3> components{};
+
+        for (size_t c = 0; c < planes.size(); ++c) {
+          //NOLINTNEXTLINE(*-pointer-arithmetic)
+          const auto& info = cinfo_->comp_info[c];
+
+          size_t stride = static_cast<size_t>(info.width_in_blocks) * DCTSIZE;
+          size_t count  = static_cast<size_t>(info.v_samp_factor)   * DCTSIZE;
+
+          samples[c].resize(stride * count);
+          rows[c].resize(count);
+          for (size_t y = 0; y < count; ++y) {
+            //NOLINTNEXTLINE(*-pointer-arithmetic)
+            rows[c][y] = samples[c].data() + y * stride;
+          }
+          components.at(c) = rows[c].data();
+        }
+
+        auto lines = utils::int_cast<JDIMENSION>(cinfo_->max_v_samp_factor * DCTSIZE);
+
+        while (cinfo_->output_scanline < cinfo_->output_height) {
+          size_t scanline = cinfo_->output_scanline;
+
+          jpeg_read_raw_data(cinfo_.get(), components.data(), lines);
+
+          for (size_t c = 0; c < planes.size(); ++c) {
+            auto& plane = *planes.at(c);
+            size_t first = scanline * rows[c].size() / lines;
+            size_t count = std::min(rows[c].size(), plane.height() - first);
+
+            for (size_t y = 0; y < count; ++y) {
+              std::ranges::copy(std::as_bytes(std::span{rows[c][y], plane.width()}),
+                                plane.row_bytes(first + y).begin());
+            }
+          }
+
+          decoder_->frame_mark_ready_until_line(
+              std::min(cinfo_->output_scanline, cinfo_->output_height));
+        }
+      }
+
+
+
       void init_error() {
         jpeg_std_error(&err_mgr_);
 
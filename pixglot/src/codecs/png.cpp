@@ -11,6 +11,7 @@
 #include "pixglot/utils/int_cast.hpp"
 
 #include <utility>
+#include <vector>
 
 #include <png.h>
 
@@ -158,19 +159,7 @@ namespace {
 
         auto fsi = create_frame_source_info(png);
 
-        pixel_format format {
-          .format   = make_format_compatible(),
-          .channels = make_color_channels_compatible()
-        };
-
-        auto& frame = decoder_->begin_frame(
-            png_get_image_width(png.ptr, png.info),
-            png_get_image_height(png.ptr, png.info),
-            format,
-            make_endian_compatible(format.format)
-        );
-
-        frame.alpha_mode(make_alpha_mode_compatible(format.channels));
+        auto& frame = begin_frame();
         frame.source_info() = std::move(fsi);
 
         fill_metadata(decoder_->image().metadata());
@@ -179,10 +168,15 @@ namespace {
                           .value_or(square_isometry::identity));
 
         if (decoder_->wants_pixel_transfer()) {
+          int passes = png_set_interlace_handling(png.ptr);
           png_read_update_info(png.ptr, png.info);
 
-          decoder_->begin_pixel_transfer();
-          transfer_data(decoder_->target());
+          if (passes == 1) {
+            decoder_->begin_strip_transfer();
+          } else {
+            decoder_->begin_pixel_transfer();
+          }
+          transfer_data(passes);
           decoder_->finish_pixel_transfer();
         }
 
@@ -197,6 +191,71 @@ namespace {
 
 
 
+      [[nodiscard]] frame& begin_frame() {
+        size_t width  = png_get_image_width(png.ptr, png.info);
+        size_t height = png_get_image_height(png.ptr, png.info);
+
+        if (png_get_color_type(png.ptr, png.info) == PNG_COLOR_TYPE_PALETTE &&
+            decoder_->wants_indexed()) {
+          auto& frame = decoder_->begin_frame(make_indexed_buffer(width, height));
+
+          frame.alpha_mode(has_alpha(frame.format().channels) ?
+                             alpha_mode::straight : alpha_mode::none);
+          return frame;
+        }
+
+        pixel_format format {
+          .format   = make_format_compatible(),
+          .channels = make_color_channels_compatible()
+        };
+
+        auto& frame = decoder_->begin_frame(width, height, format,
+                                            make_endian_compatible(format.format));
+
+        frame.alpha_mode(make_alpha_mode_compatible(format.channels));
+        return frame;
+      }
+
+
+
+      [[nodiscard]] indexed_buffer make_indexed_buffer(size_t width, size_t height) {
+        if (png_get_bit_depth(png.ptr, png.info) < 8) {
+          png_set_packing(png.ptr);
+        }
+
+        png_colorp colors{nullptr};
+        int        color_count{0};
+        if (png_get_PLTE(png.ptr, png.info, &colors, &color_count) == 0) {
+          throw decode_error{codec::png, "palette image without palette"};
+        }
+
+        png_bytep alpha{nullptr};
+        int       alpha_count{0};
+        png_get_tRNS(png.ptr, png.info, &alpha, &alpha_count, nullptr);
+
+        auto entries = std::span{colors, utils::int_cast<size_t>(color_count)};
+        auto alphas  = std::span{alpha,  utils::int_cast<size_t>(alpha_count)};
+
+        std::vector<rgba<u8>> palette(entries.size());
+        for (size_t i = 0; i < palette.size(); ++i) {
+          palette[i] = rgba<u8>{
+            .r = entries[i].red,
+            .g = entries[i].green,
+            .b = entries[i].blue,
+            .a = i < alphas.size() ? alphas[i] : u8{0xff}
+          };
+        }
+
+        auto channels = color_channels::rgb;
+        if (!alphas.empty() || decoder_->output_format().fill_alpha().prefers(true)) {
+          channels = color_channels::rgba;
+        }
+
+        return indexed_buffer{width, height, palette, channels};
+      }
+
+
+
       void fill_metadata(metadata& md) const {
         png_textp text{nullptr};
         int       num_text{0};
@@ -226,19 +285,18 @@ namespace {
 
 
 
-      void transfer_data(pixel_buffer& buffer) {
-        if (png_get_rowbytes(png.ptr, png.info) > buffer.stride()) {
+      void transfer_data(int passes) {
+        if (png_get_rowbytes(png.ptr, png.info) > decoder_->target().stride()) {
           throw decode_error{codec::png, "image stride does not fit into pixel buffer"};
         }
 
-        int    passes = png_set_interlace_handling(png.ptr);
         size_t height = png_get_image_height(png.ptr, png.info);
 
         for (int p = 0; p < passes; ++p) {
           for (size_t y = 0; y < height; ++y) {
             png_read_row(
                 png.ptr,
-                utils::byte_pointer_cast<png_byte>(buffer.row_bytes(y).data()),
+                utils::byte_pointer_cast<png_byte>(decoder_->target_row(y).data()),
                 nullptr
             );
 
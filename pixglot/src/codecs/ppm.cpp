@@ -4,10 +4,10 @@
 #include "pixglot/details/hermit.hpp"
 #include "pixglot/exception.hpp"
 #include "pixglot/frame-source-info.hpp"
+#include "pixglot/image-view.hpp"
 #include "pixglot/metadata.hpp"
 #include "pixglot/pixel-buffer.hpp"
 #include "pixglot/pixel-format.hpp"
-#include "pixglot/square-isometry.hpp"
 #include "pixglot/utils/cast.hpp"
 #include "pixglot/utils/int_cast.hpp"
 
@@ -239,7 +239,12 @@ namespace {
     size_t row_index   {0};
     size_t column_index{0};
 
-    auto row = target.row<gray<u8>>(row_index);
+    image_view<gray<u8>> view{target};
+    if (view.empty()) {
+      return;
+    }
+
+    auto row = view.row(row_index);
 
     for (auto word = source.next_word(); word; word = source.next_word()) {
       for (char b: *word) {
@@ -247,10 +252,10 @@ namespace {
 
         if (++column_index >= row.size()) {
           column_index = 0;
-          if (++row_index >= target.height()) {
+          if (++row_index >= view.height()) {
             return;
           }
-          row = target.row<gray<u8>>(row_index);
+          row = view.row(row_index);
         }
       }
     }
@@ -266,7 +271,12 @@ namespace {
     size_t row_index{0};
     size_t column_index{0};
 
-    auto row = target.row<gray<u8>>(row_index);
+    image_view<gray<u8>> view{target};
+    if (view.empty()) {
+      return;
+    }
+
+    auto row = view.row(row_index);
 
     static_assert(pixel_buffer::alignment % 8 == 0);
 
@@ -277,10 +287,10 @@ namespace {
       }
       if (column_index >= row.size()) {
         column_index = 0;
-        if (++row_index >= target.height()) {
+        if (++row_index >= view.height()) {
           return;
         }
-        row = target.row<gray<u8>>(row_index);
+        row = view.row(row_index);
       }
     }
 
@@ -309,14 +319,20 @@ namespace {
 
 
 
+  // views the components of every pixel as a gray pixel of their own
   template<data_format_type DFT>
-  [[nodiscard]] std::span<DFT> components_of_row(pixel_buffer& pixels, size_t y) {
+  [[nodiscard]] image_view<gray<DFT>> component_view(pixel_buffer& pixels) {
     if (pixels.format().format != data_format_from<DFT>::value) {
       throw bad_pixel_format{pixels.format()};
     }
 
-    return utils::interpret_as_n<DFT>(pixels.row_bytes(y),
-              pixels.width() * n_channels(pixels.format().channels));
+    if (pixels.height() == 0) {
+      return {};
+    }
+
+    return image_view<gray<DFT>>{pixels.row_bytes(0).data(),
+      pixels.width() * n_channels(pixels.format().channels), pixels.height(),
+      pixels.signed_stride()};
   }
 
 
@@ -326,19 +342,24 @@ namespace {
     size_t column_index{0};
     size_t row_index{0};
 
-    auto row = components_of_row<DFT>(target, row_index);
+    auto view = component_view<DFT>(target);
+    if (view.empty()) {
+      return;
+    }
+
+    auto row = view.row(row_index);
 
     for (auto word = reader.next_word(); word; word = reader.next_word()) {
-      row[column_index] = parse_u32(*word, range);
+      row[column_index].v = parse_u32(*word, range);
 
       if (++column_index >= row.size()) {
         column_index = 0;
 
-        if (++row_index >= target.height()) {
+        if (++row_index >= view.height()) {
           return;
         }
 
-        row = components_of_row<DFT>(target, row_index);
+        row = view.row(row_index);
       }
     }
 
@@ -351,8 +372,8 @@ namespace {
   void adjust_range(pixel_buffer& pixels, DFT range) {
     static constexpr UP max = std::integral<DFT> ? std::numeric_limits<DFT>::max() : 1.f;
 
-    for (size_t y = 0; y < pixels.height(); ++y) {
-      for (auto& component: components_of_row<DFT>(pixels, y)) {
+    for (auto row: component_view<DFT>(pixels).rows()) {
+      for (auto& [component]: row) {
         component = std::clamp<UP>((static_cast<UP>(component) * max) / range, 0, max);
       }
     }
@@ -547,8 +568,7 @@ namespace {
 
         header_.fill_frame_source_info(frame.source_info());
 
-        frame.orientation(current_orientation());
-        frame.alpha_mode (alpha_mode::none);
+        frame.alpha_mode(alpha_mode::none);
 
 
         if (decoder_->wants_pixel_transfer()) {
@@ -558,6 +578,10 @@ namespace {
           } else {
             transfer_binary(decoder_->target());
           }
+
+          // pfm stores rows from bottom to top
+          decoder_->target().bottom_up(is_float(header_.format.format));
+
           decoder_->finish_pixel_transfer();
         }
 
@@ -594,13 +618,6 @@ namespace {
 
 
 
-      [[nodiscard]] square_isometry current_orientation() const {
-        return is_float(header_.format.format)
-          ? square_isometry::flip_y : square_isometry::identity;
-      }
-
-
-
       void transfer_ascii(pixel_buffer& pixels) {
         switch (header_.type) {
           case ppm_type::bits:
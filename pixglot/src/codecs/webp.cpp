@@ -7,9 +7,15 @@
 #include "pixglot/details/xmp.hpp"
 #include "pixglot/frame.hpp"
 #include "pixglot/frame-source-info.hpp"
+#include "pixglot/metadata.hpp"
 #include "pixglot/pixel-format.hpp"
 #include "pixglot/utils/cast.hpp"
 #include "pixglot/utils/int_cast.hpp"
+#include "pixglot/yuv-buffer.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
 
 #include <webp/demux.h>
 #include <webp/mux.h>
@@ -166,6 +172,32 @@ namespace {
 
 
 
+      explicit webp_decoder_config(WebPIterator* iter, yuv_buffer& buffer) {
+        if (WebPInitDecoderConfig(&config_) == 0) {
+          throw decode_error{codec::webp, "unable to initialize decoder config"};
+        }
+
+        config_.output.width  = iter->width;
+        config_.output.height = iter->height;
+
+        config_.output.colorspace = MODE_YUV;
+
+        config_.output.is_external_memory = 1;
+
+        auto& yuva = config_.output.u.YUVA; //NOLINT(*union*)
+        yuva.y        = utils::byte_pointer_cast<uint8_t>(buffer.y().data().data());
+        yuva.y_stride = utils::int_cast<int>(buffer.y().stride());
+        yuva.y_size   = buffer.y().data().size();
+        yuva.u        = utils::byte_pointer_cast<uint8_t>(buffer.u().data().data());
+        yuva.u_stride = utils::int_cast<int>(buffer.u().stride());
+        yuva.u_size   = buffer.u().data().size();
+        yuva.v        = utils::byte_pointer_cast<uint8_t>(buffer.v().data().data());
+        yuva.v_stride = utils::int_cast<int>(buffer.v().stride());
+        yuva.v_size   = buffer.v().data().size();
+      }
+
+
+
       [[nodiscard]] WebPDecoderConfig* get() {
         return &config_;
       }
@@ -206,11 +238,19 @@ namespace {
             decoder_->warn("fragment does not contain full frame");
           }
 
-          auto& frame = decoder_->begin_frame(
+          bool planar = decoder_->wants_yuv() && is_opaque_lossy(webp_frame);
+
+          // lossy webp is limited range bt601 4:2:0
+          auto& frame = planar ?
+            decoder_->begin_frame(yuv_buffer{
+              saturating_cast(webp_frame.width),
+              saturating_cast(webp_frame.height),
+              chroma_subsampling::cs420, yuv_matrix::bt601, false}) :
+            decoder_->begin_frame(
               saturating_cast(webp_frame.width),
               saturating_cast(webp_frame.height),
               rgba<u8>::format()
-          );
+            );
 
           frame.source_info().color_model(color_model::yuv);
           frame.source_info().subsampling(chroma_subsampling::cs420);
@@ -223,16 +263,26 @@ namespace {
           });
 
           frame.duration(std::chrono::microseconds{webp_frame.duration * 1000});
-          frame.alpha_mode(
-              decoder_->output_format().alpha_mode().prefers(alpha_mode::premultiplied) ?
-              alpha_mode::premultiplied :
-              alpha_mode::straight
-          );
+
+          if (auto region = advance_changed_region(webp_frame)) {
+            frame.changed_region(*region);
+          }
+
+          if (planar) {
+            frame.alpha_mode(alpha_mode::none);
+          } else if (decoder_->output_format().alpha_mode().prefers(
+                       alpha_mode::premultiplied)) {
+            frame.alpha_mode(alpha_mode::premultiplied);
+          } else {
+            frame.alpha_mode(alpha_mode::straight);
+          }
 
           if (decoder_->wants_pixel_transfer()) {
             decoder_->begin_pixel_transfer();
-            webp_decoder_config config{&webp_frame, decoder_->target(),
-              frame.alpha_mode() == alpha_mode::premultiplied};
+            auto config = planar ?
+              webp_decoder_config{&webp_frame, frame.yuv()} :
+              webp_decoder_config{&webp_frame, decoder_->target(),
+                frame.alpha_mode() == alpha_mode::premultiplied};
 
             if (WebPDecode(webp_frame.fragment.bytes, webp_frame.fragment.size,
                   config.get()) != VP8_STATUS_OK) {
@@ -259,6 +309,8 @@ namespace {
 
       std::unique_ptr<WebPDemuxer, demux_deleter> demux_;
 
+      frame_region disposed_region_;
+
 
 
       [[nodiscard]] static constexpr size_t saturating_cast(int value) {
@@ -267,6 +319,57 @@ namespace {
 
 
 
+      [[nodiscard]] static bool contains(
+          const frame_region& outer,
+          const frame_region& inner
+      ) {
+        return inner.width == 0 || inner.height == 0 ||
+          (inner.x >= outer.x && inner.x + inner.width  <= outer.x + outer.width &&
+           inner.y >= outer.y && inner.y + inner.height <= outer.y + outer.height);
+      }
+
+
+
+      // Frames are emitted as fragments, which can only replace their part of the
+      // canvas if they do not blend with it and cover what the previous one disposed.
+      [[nodiscard]] std::optional<frame_region> advance_changed_region(
+          const WebPIterator& iter
+      ) {
+        frame_region rect{
+          .x      = saturating_cast(iter.x_offset),
+          .y      = saturating_cast(iter.y_offset),
+          .width  = saturating_cast(iter.width),
+          .height = saturating_cast(iter.height)
+        };
+
+        bool replaces = iter.frame_num == 1 ||
+          ((iter.has_alpha == 0 || iter.blend_method == WEBP_MUX_NO_BLEND) &&
+           contains(rect, disposed_region_));
+
+        disposed_region_ = iter.dispose_method == WEBP_MUX_DISPOSE_BACKGROUND ?
+          rect : frame_region{};
+
+        if (!replaces) {
+          return {};
+        }
+        return rect;
+      }
+
+
+
+      // only lossy frames without alpha are stored as yuv internally
+      [[nodiscard]] static bool is_opaque_lossy(const WebPIterator& iter) {
+        if (iter.has_alpha != 0) {
+          return false;
+        }
+
+        WebPBitstreamFeatures features{};
+        return WebPGetFeatures(iter.fragment.bytes, iter.fragment.size, &features)
+                 == VP8_STATUS_OK && features.format == 1;
+      }
+
+
+
       [[nodiscard]] static pixel_buffer create_pixel_buffer(WebPIterator* iter) {
         pixel_format format{
           .format   = data_format::u8,
@@ -296,6 +399,16 @@ namespace {
 
         auto flags = WebPDemuxGetI(demux_.get(), WEBP_FF_FORMAT_FLAGS);
 
+        // frames only cover their changed_region, a gl_canvas needs the full size
+        std::vector<metadata::key_value> out {
+          {"webp.canvas_width",
+            std::to_string(WebPDemuxGetI(demux_.get(), WEBP_FF_CANVAS_WIDTH))},
+          {"webp.canvas_height",
+            std::to_string(WebPDemuxGetI(demux_.get(), WEBP_FF_CANVAS_HEIGHT))}
+        };
+
+        decoder_->image().metadata().append_move(out);
+
 #ifdef PIXGLOT_WITH_XMP
         if ((flags & XMP_FLAG) != 0) {
           if (WebPDemuxGetChunk(demux_.get(), "XMP ", 1, iter.get()) != WEBP_MUX_OK) {
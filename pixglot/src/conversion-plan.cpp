@@ -0,0 +1,413 @@
+#include "pixglot/conversion-plan.hpp"
+
+#include "pixglot/conversions.hpp"
+#include "pixglot/details/transfer-functions.hpp"
+#include "pixglot/exception.hpp"
+#include "pixglot/frame.hpp"
+#include "pixglot/gl-texture.hpp"
+#include "pixglot/image.hpp"
+#include "pixglot/output-format.hpp"
+#include "pixglot/pixel-format.hpp"
+#include "pixglot/square-isometry.hpp"
+
+#include "config.hpp"
+
+#ifdef PIXGLOT_WITH_CPU_CONVERSIONS
+#include "pixglot/details/fused-conversion.hpp"
+#endif
+
+#include <algorithm>
+#include <optional>
+
+using namespace pixglot;
+
+
+
+namespace pixglot::details {
+  void unpack_texture_array(image&);
+
+  [[nodiscard]] bool srgb_texture_for(const frame_view&, bool);
+
+  void convert(gl_texture&, pixel_format, int, gamma_transfer, square_isometry);
+
+  void convert(pixel_buffer&, std::optional<std::endian>,
+                      pixel_format, int, gamma_transfer, square_isometry);
+}
+
+
+
+
+
+frame_description pixglot::describe(const frame& f) {
+  auto endian = std::endian::native;
+  if (f.type() == storage_type::pixel_buffer && byte_size(f.format().format) > 1) {
+    endian = f.pixels().endian();
+  }
+
+  return frame_description {
+    // layers of image::texture_array are textures, even if the frame has no pixels
+    .storage_type = f.layer() ? storage_type::gl_texture : f.type(),
+    .format       = f.format(),
+    .endian       = endian,
+    .alpha_mode   = f.alpha_mode(),
+    .gamma        = f.gamma(),
+    .orientation  = f.orientation()
+  };
+}
+
+
+
+
+
+class conversion_plan::impl {
+  public:
+    impl(const frame_description& source, const output_format& fmt, bool enforce) :
+      format_{fmt},
+      source_{source},
+      target_{source}
+    {
+      if (enforce) {
+        format_.enforce();
+      }
+
+      resolve_metadata();
+      resolve_storage();
+      resolve_endian();
+
+#ifdef PIXGLOT_WITH_CPU_CONVERSIONS
+      if ((source_.storage_type == storage_type::pixel_buffer ||
+           source_.storage_type == storage_type::indexed ||
+           source_.storage_type == storage_type::yuv) &&
+          target_.storage_type == storage_type::pixel_buffer && converts_pixels()) {
+        fused_ = details::select_fused_conversion(source_.format, source_.endian,
+            target_.format, target_endian_, premultiply_, gamma_, transform_);
+      }
+#endif
+    }
+
+
+
+    [[nodiscard]] const output_format&     format() const { return format_; }
+    [[nodiscard]] const frame_description& source() const { return source_; }
+    [[nodiscard]] const frame_description& target() const { return target_; }
+
+
+
+    [[nodiscard]] bool converts_pixels() const {
+      return source_.format != target_.format ||
+        premultiply_ != 0 ||
+        !gamma_.identity() ||
+        transform_ != square_isometry::identity;
+    }
+
+
+
+    // layers of a texture array remain untouched by the conversion
+    [[nodiscard]] bool keeps_layers() const {
+      return !converts_pixels() &&
+        target_.storage_type == storage_type::gl_texture &&
+        (*format_.texture_array() || !format_.texture_array().required());
+    }
+
+
+
+    void apply(frame& f) const {
+      convert_frame(f);
+
+      if (f.type() == storage_type::gl_texture && format_.srgb_texture().preferred()) {
+        f.texture().srgb(details::srgb_texture_for(f, *format_.srgb_texture()));
+      }
+
+      if (f.type() == storage_type::gl_texture && format_.mipmaps().prefers(true)) {
+        f.texture().generate_mipmaps();
+      }
+    }
+
+
+
+  private:
+    output_format              format_;
+
+    frame_description          source_;
+    frame_description          target_;
+
+    int                        premultiply_{0};
+    details::gamma_transfer    gamma_      {};
+    square_isometry            transform_  {square_isometry::identity};
+    std::optional<std::endian> target_endian_;
+
+#ifdef PIXGLOT_WITH_CPU_CONVERSIONS
+    std::optional<details::fused_conversion> fused_;
+#endif
+
+
+
+    void convert_frame(frame& f) const {
+      if (describe(f) != source_) {
+        throw base_exception{"Frame mismatch",
+          "conversion_plan was created for a frame of different description"};
+      }
+
+      // changed regions are given in the stored orientation
+      if (source_.orientation != target_.orientation) {
+        f.clear_changed_region();
+      }
+
+      f.orientation(target_.orientation);
+      f.alpha_mode (target_.alpha_mode);
+      f.gamma      (target_.gamma);
+
+      if (f.layer()) {
+        if (!keeps_layers()) {
+          throw base_exception{"Unable to convert frame",
+            "frames stored in a texture array must be converted as part of their image"};
+        }
+        return;
+      }
+
+      if (format_.storage_type().required() ||
+          format_.storage_type().prefers(storage_type::no_pixels)) {
+        convert_storage(f, *format_.storage_type());
+      }
+
+      if (!converts_pixels()) {
+        return;
+      }
+
+#ifndef PIXGLOT_WITH_CPU_CONVERSIONS
+      if (format_.storage_type().prefers(storage_type::gl_texture)) {
+        convert_storage(f, *format_.storage_type());
+      }
+#endif
+
+      if ((f.type() == storage_type::indexed || f.type() == storage_type::yuv) &&
+          f.type() != target_.storage_type) {
+        convert_storage(f, target_.storage_type);
+      }
+
+      if (f.type() == storage_type::indexed) {
+        convert_alpha_mode (f.indexed(), source_.alpha_mode,  target_.alpha_mode);
+        convert_gamma      (f.indexed(), source_.gamma,       target_.gamma);
+        convert_orientation(f.indexed(), source_.orientation, target_.orientation);
+
+      } else if (f.type() == storage_type::gl_texture) {
+        details::convert(f.texture(), target_.format, premultiply_, gamma_, transform_);
+
+      } else if (f.type() == storage_type::pixel_buffer) {
+#ifdef PIXGLOT_WITH_CPU_CONVERSIONS
+        if (fused_) {
+          f.pixels() = fused_->apply(f.pixels());
+        } else
+#endif
+        {
+          details::convert(f.pixels(), target_endian_,
+              target_.format, premultiply_, gamma_, transform_);
+        }
+
+        if (byte_size(f.format().format) == 1 &&
+            format_.endian().preferred()) {
+          f.pixels().endian(*format_.endian());
+        }
+      }
+    }
+
+
+
+    void resolve_metadata() {
+      if (format_.orientation().required()) {
+        transform_ = inverse(*format_.orientation()) * target_.orientation;
+        target_.orientation = *format_.orientation();
+      }
+
+
+      if (format_.alpha_mode().required()) {
+        if (target_.alpha_mode == alpha_mode::straight &&
+            *format_.alpha_mode() == alpha_mode::premultiplied) {
+          premultiply_ = 1;
+          target_.alpha_mode = alpha_mode::premultiplied;
+        } else if (target_.alpha_mode == alpha_mode::premultiplied
+                   && *format_.alpha_mode() == alpha_mode::straight) {
+          premultiply_ = -1;
+          target_.alpha_mode = alpha_mode::straight;
+        }
+      }
+
+
+      if (format_.gamma().required()) {
+        gamma_ = details::gamma_transfer::between(target_.gamma, *format_.gamma());
+        target_.gamma = *format_.gamma();
+      }
+
+
+      if (format_.fill_alpha().required()) {
+        target_.format.channels = add_alpha(target_.format.channels);
+
+        if (target_.alpha_mode == alpha_mode::none) {
+          if (format_.alpha_mode().preferred()) {
+            target_.alpha_mode = *format_.alpha_mode();
+          } else {
+            target_.alpha_mode = alpha_mode::straight;
+          }
+        }
+      }
+      if (format_.expand_gray_to_rgb().required()) {
+        target_.format.channels = add_color(target_.format.channels);
+      }
+      if (format_.data_format().required()) {
+        target_.format.format = *format_.data_format();
+      }
+    }
+
+
+
+    void resolve_storage() {
+      if (format_.storage_type().required() ||
+          format_.storage_type().prefers(storage_type::no_pixels)) {
+        target_.storage_type = *format_.storage_type();
+      }
+
+#ifndef PIXGLOT_WITH_CPU_CONVERSIONS
+      if (converts_pixels() && format_.storage_type().prefers(storage_type::gl_texture)) {
+        target_.storage_type = *format_.storage_type();
+      }
+#endif
+
+      // a palette can absorb gamma and alpha changes, but no change of the format
+      if (target_.storage_type == storage_type::indexed &&
+          source_.format != target_.format) {
+        target_.storage_type = storage_type::pixel_buffer;
+      }
+
+      // planar yuv is only kept as long as the pixels remain untouched
+      if (target_.storage_type == storage_type::yuv && converts_pixels()) {
+        target_.storage_type = storage_type::pixel_buffer;
+      }
+    }
+
+
+
+    void resolve_endian() {
+      if (format_.endian().required()) {
+        target_endian_ = *format_.endian();
+      }
+
+      if (target_.storage_type != storage_type::pixel_buffer
+          || byte_size(target_.format.format) == 1) {
+        target_.endian = std::endian::native;
+        return;
+      }
+
+      if (target_endian_) {
+        target_.endian = *target_endian_;
+      } else if (converts_pixels() && (source_.format.format != target_.format.format ||
+                 source_.storage_type != storage_type::pixel_buffer || fused_planned())) {
+        target_.endian = std::endian::native;
+      }
+    }
+
+
+
+    [[nodiscard]] bool fused_planned() const {
+      return premultiply_ != 0 || !gamma_.identity() ||
+        (source_.format != target_.format && transform_ != square_isometry::identity);
+    }
+};
+
+
+
+
+
+conversion_plan::conversion_plan(conversion_plan&&) noexcept = default;
+
+conversion_plan::conversion_plan(const conversion_plan& rhs) :
+  impl_{std::make_unique<impl>(*rhs.impl_)}
+{}
+
+
+
+conversion_plan& conversion_plan::operator=(conversion_plan&&) noexcept = default;
+
+conversion_plan& conversion_plan::operator=(const conversion_plan& rhs) {
+  impl_ = std::make_unique<impl>(*rhs.impl_);
+  return *this;
+}
+
+
+
+conversion_plan::~conversion_plan() = default;
+
+
+
+conversion_plan::conversion_plan(
+    const frame_description& source,
+    const output_format&     fmt,
+    bool                     enforce
+) :
+  impl_{std::make_unique<impl>(source, fmt, enforce)}
+{}
+
+
+
+
+
+const frame_description& conversion_plan::source() const { return impl_->source(); }
+const frame_description& conversion_plan::target() const { return impl_->target(); }
+
+
+
+bool conversion_plan::applicable(const frame& f) const {
+  return describe(f) == impl_->source();
+}
+
+
+
+bool conversion_plan::converts_pixels() const {
+  return impl_->converts_pixels();
+}
+
+
+
+
+
+void conversion_plan::apply(frame& f) const {
+  impl_->apply(f);
+}
+
+
+
+void conversion_plan::apply(image& img) const {
+  if (img.texture_array()) {
+    bool keep = std::ranges::all_of(img.frames(), [this](const frame& f) {
+      if (!f.layer()) {
+        return true;
+      }
+      if (applicable(f)) {
+        return impl_->keeps_layers();
+      }
+      return conversion_plan{describe(f), impl_->format()}.impl_->keeps_layers();
+    });
+
+    if (!keep) {
+      details::unpack_texture_array(img);
+    }
+  }
+
+  std::optional<conversion_plan> other;
+
+  for (auto& f: img.frames()) {
+    if (applicable(f)) {
+      apply(f);
+      continue;
+    }
+
+    if (!other || !other->applicable(f)) {
+      other.emplace(describe(f), impl_->format());
+    }
+
+    other->apply(f);
+  }
+
+  if (img.texture_array() && impl_->format().mipmaps().prefers(true)) {
+    img.texture_array()->generate_mipmaps();
+  }
+}
@@ -0,0 +1,348 @@
+#include "pixglot/details/cpu-dispatch.hpp"
+#include "pixglot/exception.hpp"
+#include "pixglot/image-view.hpp"
+#include "pixglot/pixel-buffer.hpp"
+#include "pixglot/pixel-format.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+using namespace pixglot;
+
+
+
+namespace {
+  // round(c * a / max) without division
+  [[nodiscard]] u8 premultiply_channel(u8 c, u8 a) {
+    u32 t = u32{c} * a + 128;
+    return static_cast<u8>((t + (t >> 8)) >> 8);
+  }
+
+  [[nodiscard]] u16 premultiply_channel(u16 c, u16 a) {
+    u32 t = u32{c} * a + 32768;
+    return static_cast<u16>((t + (t >> 16)) >> 16);
+  }
+
+
+
+  // max / a in 32.32 fixed point, rounded up so that exact halves still round up;
+  // unpremultiplying is a multiply and a shift
+  template<std::unsigned_integral T>
+  [[nodiscard]] constexpr uint64_t create_reciprocal(T a) {
+    auto max = uint64_t{std::numeric_limits<T>::max()} << 32;
+    return (max + a - 1) / a;
+  }
+
+
+
+  [[nodiscard]] consteval std::array<uint64_t, 256> create_reciprocal_table() {
+    std::array<uint64_t, 256> table{};
+    for (size_t a = 1; a < table.size(); ++a) {
+      table[a] = create_reciprocal(static_cast<u8>(a));
+    }
+    return table;
+  }
+
+  constexpr std::array<uint64_t, 256> reciprocal_table = create_reciprocal_table();
+
+
+
+  [[nodiscard]] uint64_t reciprocal(u8 a) {
+    return reciprocal_table[a];
+  }
+
+  // one division per pixel instead of per channel
+  [[nodiscard]] uint64_t reciprocal(u16 a) {
+    return create_reciprocal(a);
+  }
+
+
+
+  template<std::unsigned_integral T>
+  [[nodiscard]] T unpremultiply_channel(T c, uint64_t reciprocal) {
+    auto value = (c * reciprocal + (uint64_t{1} << 31)) >> 32;
+    return static_cast<T>(std::min<uint64_t>(value, std::numeric_limits<T>::max()));
+  }
+
+
+
+
+
+  template<pixel_type T>
+  void premultiply_scalar(std::span<T> row) {
+    for (auto& pix: row) {
+      if constexpr (has_color(T::format().channels)) {
+        pix.r = premultiply_channel(pix.r, pix.a);
+        pix.g = premultiply_channel(pix.g, pix.a);
+        pix.b = premultiply_channel(pix.b, pix.a);
+      } else {
+        pix.v = premultiply_channel(pix.v, pix.a);
+      }
+    }
+  }
+
+
+
+  template<pixel_type T>
+  void unpremultiply_scalar(std::span<T> row) {
+    for (auto& pix: row) {
+      if (pix.a == 0) {
+        continue;
+      }
+
+      auto r = reciprocal(pix.a);
+
+      if constexpr (has_color(T::format().channels)) {
+        pix.r = unpremultiply_channel(pix.r, r);
+        pix.g = unpremultiply_channel(pix.g, r);
+        pix.b = unpremultiply_channel(pix.b, r);
+      } else {
+        pix.v = unpremultiply_channel(pix.v, r);
+      }
+    }
+  }
+
+
+
+
+
+#if defined(__x86_64__) || defined(__i386__)
+  //NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+  template<int Shuffle>
+  [[nodiscard]] __m128i premultiply_u16_lanes(__m128i pixels, __m128i alpha_mask) {
+    auto alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, Shuffle), Shuffle);
+
+    auto t = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+    t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+
+    return _mm_or_si128(_mm_andnot_si128(alpha_mask, t), _mm_and_si128(alpha_mask, pixels));
+  }
+
+
+
+  template<int Shuffle>
+  [[gnu::target("avx2")]] [[nodiscard]]
+  __m256i premultiply_u16_lanes(__m256i pixels, __m256i alpha_mask) {
+    auto alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, Shuffle), Shuffle);
+
+    auto t = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), _mm256_set1_epi16(128));
+    t = _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+
+    return _mm256_or_si256(_mm256_andnot_si256(alpha_mask, t),
+                           _mm256_and_si256(alpha_mask, pixels));
+  }
+
+
+
+  template<pixel_type T>
+  [[nodiscard]] constexpr int alpha_shuffle() {
+    if constexpr (T::format().channels == color_channels::rgba) {
+      return _MM_SHUFFLE(3, 3, 3, 3);
+    } else {
+      return _MM_SHUFFLE(3, 3, 1, 1);
+    }
+  }
+
+
+
+  // 16 bytes at a time, widened to u16 lanes; the alpha lane of each pixel is
+  // broadcast over its color lanes and restored after the multiply.
+  template<pixel_type T>
+  void premultiply_u8_sse2(std::span<T> row) {
+    const auto alpha_mask = T::format().channels == color_channels::rgba ?
+      _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1) :
+      _mm_setr_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+
+    auto* data  = reinterpret_cast<u8*>(row.data());
+    auto  bytes = row.size_bytes();
+    auto  zero  = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+      auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+      auto lo = premultiply_u16_lanes<alpha_shuffle<T>()>(_mm_unpacklo_epi8(v, zero),
+                                                          alpha_mask);
+      auto hi = premultiply_u16_lanes<alpha_shuffle<T>()>(_mm_unpackhi_epi8(v, zero),
+                                                          alpha_mask);
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_packus_epi16(lo, hi));
+    }
+
+    premultiply_scalar(row.subspan(i / sizeof(T)));
+  }
+
+
+
+  // unpacking and packing work within 128 bit lanes, so the byte order is preserved
+  template<pixel_type T>
+  [[gnu::target("avx2")]]
+  void premultiply_u8_avx2(std::span<T> row) {
+    const auto alpha_mask = T::format().channels == color_channels::rgba ?
+      _mm256_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1) :
+      _mm256_setr_epi16(0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1);
+
+    auto* data  = reinterpret_cast<u8*>(row.data());
+    auto  bytes = row.size_bytes();
+    auto  zero  = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+      auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+
+      auto lo = premultiply_u16_lanes<alpha_shuffle<T>()>(_mm256_unpacklo_epi8(v, zero),
+                                                          alpha_mask);
+      auto hi = premultiply_u16_lanes<alpha_shuffle<T>()>(_mm256_unpackhi_epi8(v, zero),
+                                                          alpha_mask);
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i),
+          _mm256_packus_epi16(lo, hi));
+    }
+
+    premultiply_u8_sse2(row.subspan(i / sizeof(T)));
+  }
+  //NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+#endif
+
+
+
+
+
+#if defined(__aarch64__)
+  //NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+  [[nodiscard]] uint8x8_t premultiply_u8_lanes(uint8x8_t c, uint8x8_t a) {
+    auto t = vmull_u8(c, a);
+    return vrshrn_n_u16(vrsraq_n_u16(t, t, 8), 8);
+  }
+
+
+
+  // 8 pixels at a time, deinterleaved into one register per channel
+  template<pixel_type T>
+  void premultiply_u8_neon(std::span<T> row) {
+    auto* data = reinterpret_cast<u8*>(row.data());
+
+    size_t i = 0;
+    for (; i + 8 <= row.size(); i += 8) {
+      if constexpr (T::format().channels == color_channels::rgba) {
+        auto v = vld4_u8(data + 4 * i);
+        v.val[0] = premultiply_u8_lanes(v.val[0], v.val[3]);
+        v.val[1] = premultiply_u8_lanes(v.val[1], v.val[3]);
+        v.val[2] = premultiply_u8_lanes(v.val[2], v.val[3]);
+        vst4_u8(data + 4 * i, v);
+      } else {
+        auto v = vld2_u8(data + 2 * i);
+        v.val[0] = premultiply_u8_lanes(v.val[0], v.val[1]);
+        vst2_u8(data + 2 * i, v);
+      }
+    }
+
+    premultiply_scalar(row.subspan(i));
+  }
+  //NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+#endif
+
+
+
+
+
+  template<pixel_type T>
+  using premultiply_kernel = void(std::span<T>);
+
+  template<pixel_type T>
+  [[nodiscard]] premultiply_kernel<T>* select_premultiply_u8(std::string_view name) {
+    using enum details::instruction_set;
+
+    return details::select_kernel<premultiply_kernel<T>>(name, {
+#if defined(__x86_64__) || defined(__i386__)
+      {avx2,    premultiply_u8_avx2<T>},
+      {sse2,    premultiply_u8_sse2<T>},
+#elif defined(__aarch64__)
+      {neon,    premultiply_u8_neon<T>},
+#endif
+      {generic, premultiply_scalar<T>},
+    });
+  }
+
+  premultiply_kernel<gray_a<u8>>* const premultiply_gray_a_u8 =
+    select_premultiply_u8<gray_a<u8>>("premultiply<gray_a<u8>>");
+
+  premultiply_kernel<rgba<u8>>* const premultiply_rgba_u8 =
+    select_premultiply_u8<rgba<u8>>("premultiply<rgba<u8>>");
+
+
+
+  template<pixel_type T>
+  void premultiply_u8(std::span<T> row) {
+    if constexpr (T::format().channels == color_channels::rgba) {
+      premultiply_rgba_u8(row);
+    } else {
+      premultiply_gray_a_u8(row);
+    }
+  }
+
+
+
+
+
+  template<pixel_type T>
+  void convert_alpha(pixel_buffer& pixels, int premultiply) {
+    for (auto row: image_view<T>{pixels}.rows()) {
+      if (premultiply < 0) {
+        unpremultiply_scalar(row);
+      } else if constexpr (std::is_same_v<typename T::component, u8>) {
+        premultiply_u8(row);
+      } else {
+        premultiply_scalar(row);
+      }
+    }
+  }
+
+
+
+  template<data_format_type D>
+  void convert_alpha(pixel_buffer& pixels, int premultiply) {
+    switch (pixels.format().channels) {
+      case color_channels::gray_a: convert_alpha<gray_a<D>>(pixels, premultiply); break;
+      case color_channels::rgba:   convert_alpha<rgba  <D>>(pixels, premultiply); break;
+      case color_channels::gray:
+      case color_channels::rgb:
+        break;
+    }
+  }
+}
+
+
+
+
+
+namespace pixglot::details {
+  // Converts between straight and premultiplied alpha in place,
+  // pixels must be u8 or u16 in native endian.
+  void convert_alpha_integer(pixel_buffer& pixels, int premultiply) {
+    if (premultiply == 0) {
+      return;
+    }
+
+    pixels.unshare();
+
+    switch (pixels.format().format) {
+      case data_format::u8:  convert_alpha<u8> (pixels, premultiply); return;
+      case data_format::u16: convert_alpha<u16>(pixels, premultiply); return;
+      case data_format::u32:
+      case data_format::f16:
+      case data_format::f32:
+        break;
+    }
+
+    throw bad_pixel_format{pixels.format()};
+  }
+}
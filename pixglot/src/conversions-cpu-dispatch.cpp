@@ -0,0 +1,130 @@
+#include "pixglot/conversions.hpp"
+#include "pixglot/details/cpu-dispatch.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+using namespace pixglot;
+using namespace pixglot::details;
+
+
+
+namespace {
+  constexpr std::array instruction_sets {
+    instruction_set::generic,
+    instruction_set::sse2,
+    instruction_set::ssse3,
+    instruction_set::sse4_1,
+    instruction_set::avx,
+    instruction_set::f16c,
+    instruction_set::avx2,
+    instruction_set::avx512bw,
+    instruction_set::neon,
+  };
+
+
+
+  [[nodiscard]] bool detect(instruction_set isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+
+    switch (isa) {
+      case instruction_set::generic:  return true;
+      case instruction_set::sse2:     return __builtin_cpu_supports("sse2");
+      case instruction_set::ssse3:    return __builtin_cpu_supports("ssse3");
+      case instruction_set::sse4_1:   return __builtin_cpu_supports("sse4.1");
+      case instruction_set::avx:      return __builtin_cpu_supports("avx");
+      case instruction_set::f16c:     return __builtin_cpu_supports("avx")
+                                          && __builtin_cpu_supports("f16c");
+      case instruction_set::avx2:     return __builtin_cpu_supports("avx2");
+      case instruction_set::avx512bw: return __builtin_cpu_supports("avx512f")
+                                          && __builtin_cpu_supports("avx512bw");
+      case instruction_set::neon:     return false;
+    }
+    return false;
+#elif defined(__aarch64__)
+    return isa == instruction_set::generic || isa == instruction_set::neon;
+#else
+    return isa == instruction_set::generic;
+#endif
+  }
+
+
+
+  [[nodiscard]] instruction_set dispatch_limit() {
+    //NOLINTNEXTLINE(*-mt-unsafe)
+    const char* value = std::getenv("PIXGLOT_CPU_DISPATCH");
+    if (value == nullptr) {
+      return instruction_sets.back();
+    }
+
+    for (auto isa: instruction_sets) {
+      if (stringify(isa) == value) {
+        return isa;
+      }
+    }
+
+    return instruction_sets.back();
+  }
+
+
+
+  [[nodiscard]] std::array<bool, instruction_sets.size()> detect_all() {
+    auto limit = dispatch_limit();
+
+    std::array<bool, instruction_sets.size()> supported{};
+    for (auto isa: instruction_sets) {
+      supported[std::to_underlying(isa)] = isa <= limit && detect(isa);
+    }
+    return supported;
+  }
+
+
+
+  [[nodiscard]] std::vector<cpu_kernel>& kernel_registry() {
+    static std::vector<cpu_kernel> registry;
+    return registry;
+  }
+}
+
+
+
+
+
+std::string_view pixglot::details::stringify(instruction_set isa) {
+  switch (isa) {
+    case instruction_set::generic:  return "generic";
+    case instruction_set::sse2:     return "sse2";
+    case instruction_set::ssse3:    return "ssse3";
+    case instruction_set::sse4_1:   return "sse4.1";
+    case instruction_set::avx:      return "avx";
+    case instruction_set::f16c:     return "f16c";
+    case instruction_set::avx2:     return "avx2";
+    case instruction_set::avx512bw: return "avx512bw";
+    case instruction_set::neon:     return "neon";
+  }
+  return "<invalid instruction_set>";
+}
+
+
+
+bool pixglot::details::cpu_supports(instruction_set isa) {
+  static const auto supported = detect_all();
+  return supported.at(std::to_underlying(isa));
+}
+
+
+
+void pixglot::details::register_kernel(std::string_view name, instruction_set isa) {
+  kernel_registry().emplace_back(cpu_kernel{.name = name, .variant = stringify(isa)});
+}
+
+
+
+
+
+std::vector<cpu_kernel> pixglot::cpu_kernels() {
+  return kernel_registry();
+}
@@ -1,22 +1,159 @@
+#include "pixglot/details/cpu-dispatch.hpp"
 #include "pixglot/exception.hpp"
 #include "pixglot/pixel-buffer.hpp"
 #include "pixglot/utils/cast.hpp"
 
+#include <algorithm>
 #include <bit>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 
 
 namespace {
-  template<typename T>
-  void swap_bytes(std::span<std::byte> buffer) {
-    for (T& x: pixglot::utils::interpret_as_greedy<T>(buffer)) {
-      x = std::byteswap(x);
+  template<size_t ChunkSize> struct chunk_integer {};
+  template<> struct chunk_integer<2> { using type = pixglot::u16; };
+  template<> struct chunk_integer<4> { using type = pixglot::u32; };
+
+
+
+  template<size_t ChunkSize>
+  void swap_bytes_scalar(std::span<const std::byte> source, std::span<std::byte> target) {
+    using T = typename chunk_integer<ChunkSize>::type;
+
+    auto src = pixglot::utils::interpret_as_greedy<const T>(source);
+    auto tgt = pixglot::utils::interpret_as_greedy<T>(target);
+
+    std::ranges::transform(src, tgt.begin(), [](T x) { return std::byteswap(x); });
+  }
+
+
+
+
+
+#if defined(__x86_64__) || defined(__i386__)
+  //NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+  template<size_t ChunkSize>
+  [[gnu::target("ssse3")]] __m128i shuffle_mask_128() {
+    if constexpr (ChunkSize == 2) {
+      return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    } else {
+      return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
     }
   }
+
+
+
+  template<size_t ChunkSize>
+  [[gnu::target("ssse3")]]
+  void swap_bytes_ssse3(std::span<const std::byte> source, std::span<std::byte> target) {
+    const auto mask = shuffle_mask_128<ChunkSize>();
+
+    size_t i = 0;
+    for (; i + 16 <= source.size(); i += 16) {
+      auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(target.data() + i),
+          _mm_shuffle_epi8(v, mask));
+    }
+
+    swap_bytes_scalar<ChunkSize>(source.subspan(i), target.subspan(i));
+  }
+
+
+
+  template<size_t ChunkSize>
+  [[gnu::target("avx2")]]
+  void swap_bytes_avx2(std::span<const std::byte> source, std::span<std::byte> target) {
+    const auto mask = _mm256_broadcastsi128_si256(shuffle_mask_128<ChunkSize>());
+
+    size_t i = 0;
+    for (; i + 32 <= source.size(); i += 32) {
+      auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source.data() + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(target.data() + i),
+          _mm256_shuffle_epi8(v, mask));
+    }
+
+    swap_bytes_ssse3<ChunkSize>(source.subspan(i), target.subspan(i));
+  }
+
+
+
+  template<size_t ChunkSize>
+  [[gnu::target("avx512f,avx512bw")]]
+  void swap_bytes_avx512bw(std::span<const std::byte> source, std::span<std::byte> target) {
+    const auto lane = shuffle_mask_128<ChunkSize>();
+    const auto mask = _mm512_set4_epi32(_mm_extract_epi32(lane, 3), _mm_extract_epi32(lane, 2),
+                                        _mm_extract_epi32(lane, 1), _mm_cvtsi128_si32(lane));
+
+    size_t i = 0;
+    for (; i + 64 <= source.size(); i += 64) {
+      auto v = _mm512_loadu_si512(source.data() + i);
+      _mm512_storeu_si512(target.data() + i, _mm512_shuffle_epi8(v, mask));
+    }
+
+    swap_bytes_avx2<ChunkSize>(source.subspan(i), target.subspan(i));
+  }
+  //NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+#endif
+
+
+
+
+
+#if defined(__aarch64__)
+  //NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+  template<size_t ChunkSize>
+  void swap_bytes_neon(std::span<const std::byte> source, std::span<std::byte> target) {
+    size_t i = 0;
+    for (; i + 16 <= source.size(); i += 16) {
+      auto v = vld1q_u8(reinterpret_cast<const uint8_t*>(source.data() + i));
+      if constexpr (ChunkSize == 2) {
+        v = vrev16q_u8(v);
+      } else {
+        v = vrev32q_u8(v);
+      }
+      vst1q_u8(reinterpret_cast<uint8_t*>(target.data() + i), v);
+    }
+
+    swap_bytes_scalar<ChunkSize>(source.subspan(i), target.subspan(i));
+  }
+  //NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+#endif
+
+
+
+
+
+  using swap_kernel = void(std::span<const std::byte>, std::span<std::byte>);
+
+  template<size_t ChunkSize>
+  [[nodiscard]] swap_kernel* select_swap_kernel(std::string_view name) {
+    using enum pixglot::details::instruction_set;
+
+    return pixglot::details::select_kernel<swap_kernel>(name, {
+#if defined(__x86_64__) || defined(__i386__)
+      {avx512bw, swap_bytes_avx512bw<ChunkSize>},
+      {avx2,     swap_bytes_avx2<ChunkSize>},
+      {ssse3,    swap_bytes_ssse3<ChunkSize>},
+#elif defined(__aarch64__)
+      {neon,     swap_bytes_neon<ChunkSize>},
+#endif
+      {generic,  swap_bytes_scalar<ChunkSize>},
+    });
+  }
+
+  swap_kernel* const swap_bytes_2 = select_swap_kernel<2>("swap_bytes<2>");
+  swap_kernel* const swap_bytes_4 = select_swap_kernel<4>("swap_bytes<4>");
 }
 
 
 
+
+
 namespace pixglot::details {
   [[nodiscard]] std::endian swap_endian(std::endian endian) {
     if (endian == std::endian::little) {
@@ -27,15 +164,26 @@ namespace pixglot::details {
 
 
 
-  void swap_bytes(std::span<std::byte> buffer, size_t chunk_size) {
+  void swap_bytes(
+      std::span<const std::byte> source,
+      std::span<std::byte>       target,
+      size_t                     chunk_size
+  ) {
+    if (target.size() < source.size()) {
+      throw std::out_of_range{"swap_bytes: target smaller than source"};
+    }
+
     if (chunk_size == 1) {
+      if (source.data() != target.data()) {
+        std::ranges::copy(source, target.begin());
+      }
       return;
     }
 
     if (chunk_size == 2) {
-      ::swap_bytes<pixglot::u16>(buffer);
+      swap_bytes_2(source, target);
     } else if (chunk_size == 4) {
-      ::swap_bytes<pixglot::u32>(buffer);
+      swap_bytes_4(source, target);
     } else {
       throw pixglot::base_exception{
         "Unable to swap bytes",
@@ -47,6 +195,12 @@ namespace pixglot::details {
 
 
 
+  void swap_bytes(std::span<std::byte> buffer, size_t chunk_size) {
+    swap_bytes(buffer, buffer, chunk_size);
+  }
+
+
+
   void apply_byte_swap(pixglot::pixel_buffer& pb) {
     pb.endian(swap_endian(pb.endian()));
 
@@ -56,6 +210,7 @@ namespace pixglot::details {
 
     static_assert(pixglot::pixel_buffer::padding() % 4 == 0);
 
+    pb.unshare();
     swap_bytes(pb.data(), byte_size(pb.format().format));
   }
 }
@@ -0,0 +1,150 @@
+#include "pixglot/details/cpu-dispatch.hpp"
+#include "pixglot/pixel-format.hpp"
+
+#include <algorithm>
+#include <span>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+using namespace pixglot;
+
+
+
+namespace {
+  void f16_to_f32_scalar(std::span<const f16> source, std::span<f32> target) {
+    std::ranges::transform(source, target.begin(), [](f16 v) {
+      return static_cast<f32>(v);
+    });
+  }
+
+
+
+  void f32_to_f16_scalar(std::span<const f32> source, std::span<f16> target) {
+    std::ranges::transform(source, target.begin(), [](f32 v) {
+      return static_cast<f16>(v);
+    });
+  }
+
+
+
+
+
+#if defined(__x86_64__) || defined(__i386__)
+  //NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+  [[gnu::target("avx,f16c")]]
+  void f16_to_f32_f16c(std::span<const f16> source, std::span<f32> target) {
+    size_t i = 0;
+    for (; i + 8 <= source.size(); i += 8) {
+      auto half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + i));
+      _mm256_storeu_ps(target.data() + i, _mm256_cvtph_ps(half));
+    }
+
+    f16_to_f32_scalar(source.subspan(i), target.subspan(i));
+  }
+
+
+
+  [[gnu::target("avx,f16c")]]
+  void f32_to_f16_f16c(std::span<const f32> source, std::span<f16> target) {
+    size_t i = 0;
+    for (; i + 8 <= source.size(); i += 8) {
+      auto full = _mm256_loadu_ps(source.data() + i);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(target.data() + i),
+          _mm256_cvtps_ph(full, _MM_FROUND_TO_NEAREST_INT));
+    }
+
+    f32_to_f16_scalar(source.subspan(i), target.subspan(i));
+  }
+  //NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+#endif
+
+
+
+
+
+#if defined(__aarch64__)
+  //NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+  void f16_to_f32_neon(std::span<const f16> source, std::span<f32> target) {
+    size_t i = 0;
+    for (; i + 4 <= source.size(); i += 4) {
+      auto half = vld1_u16(reinterpret_cast<const uint16_t*>(source.data() + i));
+      vst1q_f32(target.data() + i, vcvt_f32_f16(vreinterpret_f16_u16(half)));
+    }
+
+    f16_to_f32_scalar(source.subspan(i), target.subspan(i));
+  }
+
+
+
+  void f32_to_f16_neon(std::span<const f32> source, std::span<f16> target) {
+    size_t i = 0;
+    for (; i + 4 <= source.size(); i += 4) {
+      auto half = vcvt_f16_f32(vld1q_f32(source.data() + i));
+      vst1_u16(reinterpret_cast<uint16_t*>(target.data() + i), vreinterpret_u16_f16(half));
+    }
+
+    f32_to_f16_scalar(source.subspan(i), target.subspan(i));
+  }
+  //NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+#endif
+
+
+
+
+
+  using f16_to_f32_kernel = void(std::span<const f16>, std::span<f32>);
+  using f32_to_f16_kernel = void(std::span<const f32>, std::span<f16>);
+
+
+
+  [[nodiscard]] f16_to_f32_kernel* select_f16_to_f32() {
+    using enum details::instruction_set;
+
+    return details::select_kernel<f16_to_f32_kernel>("f16_to_f32", {
+#if defined(__x86_64__) || defined(__i386__)
+      {f16c,    f16_to_f32_f16c},
+#elif defined(__aarch64__)
+      {neon,    f16_to_f32_neon},
+#endif
+      {generic, f16_to_f32_scalar},
+    });
+  }
+
+
+
+  [[nodiscard]] f32_to_f16_kernel* select_f32_to_f16() {
+    using enum details::instruction_set;
+
+    return details::select_kernel<f32_to_f16_kernel>("f32_to_f16", {
+#if defined(__x86_64__) || defined(__i386__)
+      {f16c,    f32_to_f16_f16c},
+#elif defined(__aarch64__)
+      {neon,    f32_to_f16_neon},
+#endif
+      {generic, f32_to_f16_scalar},
+    });
+  }
+
+  f16_to_f32_kernel* const f16_to_f32 = select_f16_to_f32();
+  f32_to_f16_kernel* const f32_to_f16 = select_f32_to_f16();
+}
+
+
+
+
+
+namespace pixglot::details {
+  void convert_f16_to_f32(std::span<const f16> source, std::span<f32> target) {
+    f16_to_f32(source, target);
+  }
+
+
+
+  void convert_f32_to_f16(std::span<const f32> source, std::span<f16> target) {
+    f32_to_f16(source, target);
+  }
+}
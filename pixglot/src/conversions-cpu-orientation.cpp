@@ -1,11 +1,25 @@
+#include "pixglot/details/cpu-dispatch.hpp"
 #include "pixglot/exception.hpp"
 #include "pixglot/pixel-buffer.hpp"
 #include "pixglot/square-isometry.hpp"
 #include "pixglot/utils/cast.hpp"
 
+#include "config.hpp"
+
 #include <algorithm>
+#include <array>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#ifdef PIXGLOT_WITH_THREADED_CONVERSIONS
+#include <thread>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 using namespace pixglot;
 
 
@@ -57,34 +71,72 @@ namespace {
 
 
 
-  template<size_t ChunkSize>
-  void rotate_half_sized(pixel_buffer& pixels) {
-    for (size_t y = 0; y < pixels.height() / 2; ++y) {
-      auto source = chunked<ChunkSize>(pixels.row_bytes(y));
-      auto target = chunked<ChunkSize>(pixels.row_bytes(pixels.height() - 1 - y));
+  // Row access for the transposing rotations: the extra flips of rotate_cw, rotate_ccw
+  // and anti_transpose are folded into the transpose by visiting rows in reverse,
+  // just like the row order of bottom_up buffers.
+  template<typename Byte>
+  class strided_rows {
+    public:
+      template<typename Buffer>
+      strided_rows(Buffer& buffer, bool reverse) :
+        data_   {buffer.data().data()},
+        stride_ {buffer.stride()},
+        last_   {buffer.height() - 1},
+        reverse_{reverse != buffer.bottom_up()}
+      {}
+
+      [[nodiscard]] Byte* operator()(size_t index, size_t offset) const {
+        //NOLINTNEXTLINE(*-pointer-arithmetic)
+        return data_ + (reverse_ ? last_ - index : index) * stride_ + offset;
+      }
+
+    private:
+      Byte*  data_;
+      size_t stride_;
+      size_t last_;
+      bool   reverse_;
+  };
+
+  using source_rows = strided_rows<const std::byte>;
+  using target_rows = strided_rows<std::byte>;
 
-      std::swap_ranges(source.begin(), source.end(), target.rbegin());
-    }
 
-    if (pixels.height() % 2 != 0) {
-      std::ranges::reverse(chunked<ChunkSize>(pixels.row_bytes(pixels.height() / 2)));
+
+  template<size_t ChunkSize>
+  [[nodiscard]] constexpr size_t tile_size() {
+    // source and target tile together should stay well within L1
+    size_t size = 8;
+    while (2 * (2 * size) * (2 * size) * ChunkSize <= 16 * 1024) {
+      size *= 2;
     }
+    return size;
   }
 
 
 
-  void rotate_half(pixel_buffer& pixels) {
-    switch (pixels.format().size()) {
-      case 1:  rotate_half_sized<1> (pixels); break;
-      case 2:  rotate_half_sized<2> (pixels); break;
-      case 3:  rotate_half_sized<3> (pixels); break;
-      case 4:  rotate_half_sized<4> (pixels); break;
-      case 6:  rotate_half_sized<6> (pixels); break;
-      case 8:  rotate_half_sized<8> (pixels); break;
-      case 12: rotate_half_sized<12>(pixels); break;
-      case 16: rotate_half_sized<16>(pixels); break;
-      default:
-        throw pixglot::bad_pixel_format{pixels.format()};
+  template<size_t ChunkSize>
+  [[nodiscard]] constexpr size_t sse2_micro_size() {
+    return ChunkSize <= 2 ? 8 : 16 / ChunkSize;
+  }
+
+  template<size_t ChunkSize>
+  [[nodiscard]] constexpr size_t avx2_micro_size() {
+    return 32 / ChunkSize;
+  }
+
+
+
+  // Transposes the N×N block of pixels src[i][0..N) into tgt[0..N)[i]
+  template<size_t ChunkSize, size_t N>
+  void transpose_micro_scalar(
+      const std::array<const std::byte*, N>& src,
+      const std::array<std::byte*, N>&       tgt
+  ) {
+    for (size_t i = 0; i < N; ++i) {
+      for (size_t j = 0; j < N; ++j) {
+        //NOLINTNEXTLINE(*-pointer-arithmetic)
+        std::ranges::copy_n(src[i] + j * ChunkSize, ChunkSize, tgt[j] + i * ChunkSize);
+      }
     }
   }
 
@@ -92,50 +144,421 @@ namespace {
 
 
 
+#if defined(__x86_64__) || defined(__i386__)
+  //NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+  [[nodiscard]] __m128i load(const std::byte* ptr) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+  }
+
+  void store(std::byte* ptr, __m128i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value);
+  }
+
+  [[nodiscard]] __m128i load_low(const std::byte* ptr) {
+    return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr));
+  }
+
+  void store_low(std::byte* ptr, __m128i value) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(ptr), value);
+  }
+
+
+
+  void transpose_micro(
+      const std::array<const std::byte*, 8>& src,
+      const std::array<std::byte*, 8>&       tgt,
+      std::integral_constant<size_t, 1> /*chunk_size*/
+  ) {
+    auto s0 = _mm_unpacklo_epi8(load_low(src[0]), load_low(src[1]));
+    auto s1 = _mm_unpacklo_epi8(load_low(src[2]), load_low(src[3]));
+    auto s2 = _mm_unpacklo_epi8(load_low(src[4]), load_low(src[5]));
+    auto s3 = _mm_unpacklo_epi8(load_low(src[6]), load_low(src[7]));
+
+    auto u0 = _mm_unpacklo_epi16(s0, s1);
+    auto u1 = _mm_unpackhi_epi16(s0, s1);
+    auto u2 = _mm_unpacklo_epi16(s2, s3);
+    auto u3 = _mm_unpackhi_epi16(s2, s3);
+
+    auto v0 = _mm_unpacklo_epi32(u0, u2);
+    auto v1 = _mm_unpackhi_epi32(u0, u2);
+    auto v2 = _mm_unpacklo_epi32(u1, u3);
+    auto v3 = _mm_unpackhi_epi32(u1, u3);
+
+    store_low(tgt[0], v0);
+    store_low(tgt[1], _mm_srli_si128(v0, 8));
+    store_low(tgt[2], v1);
+    store_low(tgt[3], _mm_srli_si128(v1, 8));
+    store_low(tgt[4], v2);
+    store_low(tgt[5], _mm_srli_si128(v2, 8));
+    store_low(tgt[6], v3);
+    store_low(tgt[7], _mm_srli_si128(v3, 8));
+  }
+
+
+
+  void transpose_micro(
+      const std::array<const std::byte*, 8>& src,
+      const std::array<std::byte*, 8>&       tgt,
+      std::integral_constant<size_t, 2> /*chunk_size*/
+  ) {
+    auto r0 = load(src[0]);
+    auto r1 = load(src[1]);
+    auto r2 = load(src[2]);
+    auto r3 = load(src[3]);
+    auto r4 = load(src[4]);
+    auto r5 = load(src[5]);
+    auto r6 = load(src[6]);
+    auto r7 = load(src[7]);
+
+    auto s0 = _mm_unpacklo_epi16(r0, r1);
+    auto s1 = _mm_unpackhi_epi16(r0, r1);
+    auto s2 = _mm_unpacklo_epi16(r2, r3);
+    auto s3 = _mm_unpackhi_epi16(r2, r3);
+    auto s4 = _mm_unpacklo_epi16(r4, r5);
+    auto s5 = _mm_unpackhi_epi16(r4, r5);
+    auto s6 = _mm_unpacklo_epi16(r6, r7);
+    auto s7 = _mm_unpackhi_epi16(r6, r7);
+
+    auto u0 = _mm_unpacklo_epi32(s0, s2);
+    auto u1 = _mm_unpackhi_epi32(s0, s2);
+    auto u2 = _mm_unpacklo_epi32(s1, s3);
+    auto u3 = _mm_unpackhi_epi32(s1, s3);
+    auto u4 = _mm_unpacklo_epi32(s4, s6);
+    auto u5 = _mm_unpackhi_epi32(s4, s6);
+    auto u6 = _mm_unpacklo_epi32(s5, s7);
+    auto u7 = _mm_unpackhi_epi32(s5, s7);
+
+    store(tgt[0], _mm_unpacklo_epi64(u0, u4));
+    store(tgt[1], _mm_unpackhi_epi64(u0, u4));
+    store(tgt[2], _mm_unpacklo_epi64(u1, u5));
+    store(tgt[3], _mm_unpackhi_epi64(u1, u5));
+    store(tgt[4], _mm_unpacklo_epi64(u2, u6));
+    store(tgt[5], _mm_unpackhi_epi64(u2, u6));
+    store(tgt[6], _mm_unpacklo_epi64(u3, u7));
+    store(tgt[7], _mm_unpackhi_epi64(u3, u7));
+  }
+
+
+
+  void transpose_micro(
+      const std::array<const std::byte*, 4>& src,
+      const std::array<std::byte*, 4>&       tgt,
+      std::integral_constant<size_t, 4> /*chunk_size*/
+  ) {
+    auto r0 = load(src[0]);
+    auto r1 = load(src[1]);
+    auto r2 = load(src[2]);
+    auto r3 = load(src[3]);
+
+    auto t0 = _mm_unpacklo_epi32(r0, r1);
+    auto t1 = _mm_unpacklo_epi32(r2, r3);
+    auto t2 = _mm_unpackhi_epi32(r0, r1);
+    auto t3 = _mm_unpackhi_epi32(r2, r3);
+
+    store(tgt[0], _mm_unpacklo_epi64(t0, t1));
+    store(tgt[1], _mm_unpackhi_epi64(t0, t1));
+    store(tgt[2], _mm_unpacklo_epi64(t2, t3));
+    store(tgt[3], _mm_unpackhi_epi64(t2, t3));
+  }
+
+
+
+  void transpose_micro(
+      const std::array<const std::byte*, 2>& src,
+      const std::array<std::byte*, 2>&       tgt,
+      std::integral_constant<size_t, 8> /*chunk_size*/
+  ) {
+    auto r0 = load(src[0]);
+    auto r1 = load(src[1]);
+
+    store(tgt[0], _mm_unpacklo_epi64(r0, r1));
+    store(tgt[1], _mm_unpackhi_epi64(r0, r1));
+  }
+  //NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+
+
+
   template<size_t ChunkSize>
-  void transpose_sized(const pixel_buffer& source, pixel_buffer& target) {
-    std::vector<std::span<chunk_type<ChunkSize>>> target_rows;
-    target_rows.reserve(target.height());
-    for (size_t y = 0; y < target.height(); ++y) {
-      target_rows.emplace_back(chunked<ChunkSize>(target.row_bytes(y)));
-    }
+  void transpose_micro_sse2(
+      const std::array<const std::byte*, sse2_micro_size<ChunkSize>()>& src,
+      const std::array<std::byte*, sse2_micro_size<ChunkSize>()>&       tgt
+  ) {
+    transpose_micro(src, tgt, std::integral_constant<size_t, ChunkSize>{});
+  }
+
+
+
+  //NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+  [[gnu::target("avx2")]] [[nodiscard]] __m256i load_256(const std::byte* ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+  }
+
+  [[gnu::target("avx2")]] void store_256(std::byte* ptr, __m256i value) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), value);
+  }
+  //NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+
+
+
+  [[gnu::target("avx2")]]
+  void transpose_micro_avx2(
+      const std::array<const std::byte*, 8>& src,
+      const std::array<std::byte*, 8>&       tgt,
+      std::integral_constant<size_t, 4> /*chunk_size*/
+  ) {
+    auto r0 = load_256(src[0]);
+    auto r1 = load_256(src[1]);
+    auto r2 = load_256(src[2]);
+    auto r3 = load_256(src[3]);
+    auto r4 = load_256(src[4]);
+    auto r5 = load_256(src[5]);
+    auto r6 = load_256(src[6]);
+    auto r7 = load_256(src[7]);
+
+    auto t0 = _mm256_unpacklo_epi32(r0, r1);
+    auto t1 = _mm256_unpackhi_epi32(r0, r1);
+    auto t2 = _mm256_unpacklo_epi32(r2, r3);
+    auto t3 = _mm256_unpackhi_epi32(r2, r3);
+    auto t4 = _mm256_unpacklo_epi32(r4, r5);
+    auto t5 = _mm256_unpackhi_epi32(r4, r5);
+    auto t6 = _mm256_unpacklo_epi32(r6, r7);
+    auto t7 = _mm256_unpackhi_epi32(r6, r7);
+
+    // columns j and j + 4 of rows 0-3 and rows 4-7
+    auto u0 = _mm256_unpacklo_epi64(t0, t2);
+    auto u1 = _mm256_unpackhi_epi64(t0, t2);
+    auto u2 = _mm256_unpacklo_epi64(t1, t3);
+    auto u3 = _mm256_unpackhi_epi64(t1, t3);
+    auto u4 = _mm256_unpacklo_epi64(t4, t6);
+    auto u5 = _mm256_unpackhi_epi64(t4, t6);
+    auto u6 = _mm256_unpacklo_epi64(t5, t7);
+    auto u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    store_256(tgt[0], _mm256_permute2x128_si256(u0, u4, 0x20));
+    store_256(tgt[1], _mm256_permute2x128_si256(u1, u5, 0x20));
+    store_256(tgt[2], _mm256_permute2x128_si256(u2, u6, 0x20));
+    store_256(tgt[3], _mm256_permute2x128_si256(u3, u7, 0x20));
+    store_256(tgt[4], _mm256_permute2x128_si256(u0, u4, 0x31));
+    store_256(tgt[5], _mm256_permute2x128_si256(u1, u5, 0x31));
+    store_256(tgt[6], _mm256_permute2x128_si256(u2, u6, 0x31));
+    store_256(tgt[7], _mm256_permute2x128_si256(u3, u7, 0x31));
+  }
+
+
+
+  [[gnu::target("avx2")]]
+  void transpose_micro_avx2(
+      const std::array<const std::byte*, 4>& src,
+      const std::array<std::byte*, 4>&       tgt,
+      std::integral_constant<size_t, 8> /*chunk_size*/
+  ) {
+    auto r0 = load_256(src[0]);
+    auto r1 = load_256(src[1]);
+    auto r2 = load_256(src[2]);
+    auto r3 = load_256(src[3]);
+
+    auto t0 = _mm256_unpacklo_epi64(r0, r1);
+    auto t1 = _mm256_unpackhi_epi64(r0, r1);
+    auto t2 = _mm256_unpacklo_epi64(r2, r3);
+    auto t3 = _mm256_unpackhi_epi64(r2, r3);
+
+    store_256(tgt[0], _mm256_permute2x128_si256(t0, t2, 0x20));
+    store_256(tgt[1], _mm256_permute2x128_si256(t1, t3, 0x20));
+    store_256(tgt[2], _mm256_permute2x128_si256(t0, t2, 0x31));
+    store_256(tgt[3], _mm256_permute2x128_si256(t1, t3, 0x31));
+  }
+
+
+
+  template<size_t ChunkSize>
+  [[gnu::target("avx2")]]
+  void transpose_micro_avx2(
+      const std::array<const std::byte*, avx2_micro_size<ChunkSize>()>& src,
+      const std::array<std::byte*, avx2_micro_size<ChunkSize>()>&       tgt
+  ) {
+    transpose_micro_avx2(src, tgt, std::integral_constant<size_t, ChunkSize>{});
+  }
+#endif
+
+
+
+
+
+  // Copies the tile of source rows [y0, y1) and columns [x0, x1) into the target
+  template<size_t ChunkSize, size_t N, auto Micro>
+  void transpose_tile(
+      const source_rows& source,
+      const target_rows& target,
+      size_t x0, size_t x1, size_t y0, size_t y1
+  ) {
+    std::array<const std::byte*, N> src{};
+    std::array<std::byte*, N>       tgt{};
+
+    size_t y = y0;
+    for (; y + N <= y1; y += N) {
+      size_t x = x0;
+      for (; x + N <= x1; x += N) {
+        for (size_t i = 0; i < N; ++i) {
+          src[i] = source(y + i, x * ChunkSize);
+          tgt[i] = target(x + i, y * ChunkSize);
+        }
+        Micro(src, tgt);
+      }
 
-    for (size_t y = 0; y < source.height(); ++y) {
-      auto srow = chunked<ChunkSize>(source.row_bytes(y));
+      for (; x < x1; ++x) {
+        for (size_t i = 0; i < N; ++i) {
+          std::ranges::copy_n(source(y + i, x * ChunkSize), ChunkSize,
+                              target(x, (y + i) * ChunkSize));
+        }
+      }
+    }
 
-      for (size_t x = 0; x < source.width(); ++x) {
-        target_rows[x][y] = srow[x];
+    for (; y < y1; ++y) {
+      for (size_t x = x0; x < x1; ++x) {
+        std::ranges::copy_n(source(y, x * ChunkSize), ChunkSize, target(x, y * ChunkSize));
       }
     }
   }
 
 
 
-  void transpose(const pixel_buffer& source, pixel_buffer& target) {
-    switch (source.format().size()) {
-      case 1:  transpose_sized<1> (source, target); break;
-      case 2:  transpose_sized<2> (source, target); break;
-      case 3:  transpose_sized<3> (source, target); break;
-      case 4:  transpose_sized<4> (source, target); break;
-      case 6:  transpose_sized<6> (source, target); break;
-      case 8:  transpose_sized<8> (source, target); break;
-      case 12: transpose_sized<12>(source, target); break;
-      case 16: transpose_sized<16>(source, target); break;
-      default:
-        throw pixglot::bad_pixel_format{source.format()};
+  using tile_kernel = void(const source_rows&, const target_rows&,
+                           size_t, size_t, size_t, size_t);
+
+  template<size_t ChunkSize>
+  constexpr tile_kernel* transpose_tile_generic =
+    transpose_tile<ChunkSize, 1, transpose_micro_scalar<ChunkSize, 1>>;
+
+
+
+#if defined(__x86_64__) || defined(__i386__)
+  template<size_t ChunkSize>
+  constexpr tile_kernel* transpose_tile_sse2 =
+    transpose_tile<ChunkSize, sse2_micro_size<ChunkSize>(), transpose_micro_sse2<ChunkSize>>;
+
+
+
+  template<size_t ChunkSize>
+  [[gnu::target("avx2")]]
+  void transpose_tile_avx2(
+      const source_rows& source,
+      const target_rows& target,
+      size_t x0, size_t x1, size_t y0, size_t y1
+  ) {
+    transpose_tile<ChunkSize, avx2_micro_size<ChunkSize>(), transpose_micro_avx2<ChunkSize>>
+      (source, target, x0, x1, y0, y1);
+  }
+#endif
+
+
+
+  template<size_t ChunkSize>
+  [[nodiscard]] tile_kernel* select_tile_kernel(std::string_view name) {
+    using enum details::instruction_set;
+
+#if defined(__x86_64__) || defined(__i386__)
+    if constexpr (ChunkSize == 4 || ChunkSize == 8) {
+      return details::select_kernel<tile_kernel>(name, {
+        {avx2,    transpose_tile_avx2<ChunkSize>},
+        {sse2,    transpose_tile_sse2<ChunkSize>},
+        {generic, transpose_tile_generic<ChunkSize>},
+      });
+    } else {
+      return details::select_kernel<tile_kernel>(name, {
+        {sse2,    transpose_tile_sse2<ChunkSize>},
+        {generic, transpose_tile_generic<ChunkSize>},
+      });
     }
+#else
+    return details::select_kernel<tile_kernel>(name, {
+      {generic, transpose_tile_generic<ChunkSize>},
+    });
+#endif
   }
 
+  tile_kernel* const transpose_tile_1 = select_tile_kernel<1>("transpose<1>");
+  tile_kernel* const transpose_tile_2 = select_tile_kernel<2>("transpose<2>");
+  tile_kernel* const transpose_tile_4 = select_tile_kernel<4>("transpose<4>");
+  tile_kernel* const transpose_tile_8 = select_tile_kernel<8>("transpose<8>");
+
+
+
+  template<size_t ChunkSize>
+  [[nodiscard]] tile_kernel* transpose_tile_kernel() {
+    switch (ChunkSize) {
+      case 1:  return transpose_tile_1;
+      case 2:  return transpose_tile_2;
+      case 4:  return transpose_tile_4;
+      case 8:  return transpose_tile_8;
+      default: return transpose_tile_generic<ChunkSize>;
+    }
+  }
+
+
+
+  template<size_t ChunkSize>
+  void transpose_sized(
+      const pixel_buffer& source, bool reverse_source,
+      pixel_buffer&       target, bool reverse_target
+  ) {
+    if (source.width() == 0 || source.height() == 0) {
+      return;
+    }
+
+    source_rows src{source, reverse_source};
+    target_rows tgt{target, reverse_target};
+
+    static constexpr size_t tile = tile_size<ChunkSize>();
 
+    auto* kernel = transpose_tile_kernel<ChunkSize>();
+
+    // every task owns a band of target rows, so tasks never write to the same row
+    auto transpose_band = [&](size_t x_begin, size_t x_end) {
+      for (size_t x = x_begin; x < x_end; x += tile) {
+        for (size_t y = 0; y < source.height(); y += tile) {
+          kernel(src, tgt,
+              x, std::min(x + tile, x_end), y, std::min(y + tile, source.height()));
+        }
+      }
+    };
 
+#ifdef PIXGLOT_WITH_THREADED_CONVERSIONS
+    size_t threads = std::min<size_t>(std::thread::hardware_concurrency(),
+        source.width() * source.height() * ChunkSize / (1024 * 1024));
 
+    if (threads > 1) {
+      size_t band = (source.width() + threads - 1) / threads;
+      band = (band + tile - 1) / tile * tile;
 
-  void flip_y(pixel_buffer& pixels) {
-    for (size_t y = 0; y < pixels.height() / 2; ++y) {
-      std::ranges::swap_ranges(
-          pixels.row_bytes(y),
-          pixels.row_bytes(pixels.height() - 1 - y)
-      );
+      std::vector<std::jthread> workers;
+      for (size_t x = band; x < source.width(); x += band) {
+        workers.emplace_back(transpose_band, x, std::min(x + band, source.width()));
+      }
+      transpose_band(0, std::min(band, source.width()));
+      return;
+    }
+#endif
+
+    transpose_band(0, source.width());
+  }
+
+
+
+  void transpose(
+      const pixel_buffer& source, bool reverse_source,
+      pixel_buffer&       target, bool reverse_target
+  ) {
+    switch (source.format().size()) {
+      case 1:  transpose_sized<1> (source, reverse_source, target, reverse_target); break;
+      case 2:  transpose_sized<2> (source, reverse_source, target, reverse_target); break;
+      case 3:  transpose_sized<3> (source, reverse_source, target, reverse_target); break;
+      case 4:  transpose_sized<4> (source, reverse_source, target, reverse_target); break;
+      case 6:  transpose_sized<6> (source, reverse_source, target, reverse_target); break;
+      case 8:  transpose_sized<8> (source, reverse_source, target, reverse_target); break;
+      case 12: transpose_sized<12>(source, reverse_source, target, reverse_target); break;
+      case 16: transpose_sized<16>(source, reverse_source, target, reverse_target); break;
+      default:
+        throw pixglot::bad_pixel_format{source.format()};
     }
   }
 
@@ -144,28 +567,26 @@ namespace {
 
 
   void transform_flips_xy(
-      pixel_buffer&   source,
-      pixel_buffer&   target,
-      square_isometry orientation
+      const pixel_buffer& source,
+      pixel_buffer&       target,
+      square_isometry     orientation
   ) {
+    // arguments: source, reverse source rows, target, reverse target rows
     switch (orientation) {
       case square_isometry::rotate_cw:
-        flip_y(source);
-        transpose(source, target);
+        transpose(source, true, target, false);
         break;
 
       case square_isometry::rotate_ccw:
-        transpose(source, target);
-        flip_y(target);
+        transpose(source, false, target, true);
         break;
 
       case square_isometry::transpose:
-        transpose(source, target);
+        transpose(source, false, target, false);
         break;
 
       case square_isometry::anti_transpose:
-        transpose(source, target);
-        rotate_half(target);
+        transpose(source, true, target, true);
         break;
 
       default:
@@ -183,15 +604,18 @@ namespace pixglot::details {
         break;
 
       case square_isometry::flip_y:
-        flip_y(pixels);
+        pixels.bottom_up(!pixels.bottom_up());
         break;
 
       case square_isometry::flip_x:
+        pixels.unshare();
         flip_x(pixels);
         break;
 
       case square_isometry::rotate_half:
-        rotate_half(pixels);
+        pixels.unshare();
+        flip_x(pixels);
+        pixels.bottom_up(!pixels.bottom_up());
         break;
 
       default: {
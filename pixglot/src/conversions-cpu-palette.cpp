@@ -0,0 +1,139 @@
+#include "pixglot/details/cpu-dispatch.hpp"
+#include "pixglot/indexed-buffer.hpp"
+#include "pixglot/pixel-buffer.hpp"
+#include "pixglot/utils/cast.hpp"
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+
+
+namespace {
+  using palette_table = std::array<pixglot::rgba<pixglot::u8>,
+                                   pixglot::indexed_buffer::max_palette_size>;
+
+
+
+  void expand_rgba_scalar(
+      std::span<const pixglot::u8>          indices,
+      const palette_table&                  table,
+      std::span<pixglot::rgba<pixglot::u8>> target
+  ) {
+    std::ranges::transform(indices, target.begin(), [&table](auto ix) {
+        return table[ix]; //NOLINT(*-constant-array-index)
+    });
+  }
+
+
+
+
+
+#if defined(__x86_64__) || defined(__i386__)
+  //NOLINTBEGIN(*-reinterpret-cast,*-pointer-arithmetic)
+  [[gnu::target("avx2")]]
+  void expand_rgba_avx2(
+      std::span<const pixglot::u8>          indices,
+      const palette_table&                  table,
+      std::span<pixglot::rgba<pixglot::u8>> target
+  ) {
+    const auto* base = reinterpret_cast<const int*>(table.data());
+
+    size_t i = 0;
+    for (; i + 8 <= indices.size(); i += 8) {
+      auto ix = _mm256_cvtepu8_epi32(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i*>(indices.data() + i)));
+
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(target.data() + i),
+          _mm256_i32gather_epi32(base, ix, 4));
+    }
+
+    expand_rgba_scalar(indices.subspan(i), table, target.subspan(i));
+  }
+
+
+
+  [[gnu::target("avx512f,avx512bw")]]
+  void expand_rgba_avx512bw(
+      std::span<const pixglot::u8>          indices,
+      const palette_table&                  table,
+      std::span<pixglot::rgba<pixglot::u8>> target
+  ) {
+    const auto* base = table.data();
+
+    // the masked forms avoid gcc's false uninitialized warnings for the plain ones
+    const __mmask16 all  = 0xffff;
+    const auto      zero = _mm512_setzero_si512();
+
+    size_t i = 0;
+    for (; i + 16 <= indices.size(); i += 16) {
+      auto ix = _mm512_maskz_cvtepu8_epi32(all,
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(indices.data() + i)));
+
+      _mm512_storeu_si512(target.data() + i,
+          _mm512_mask_i32gather_epi32(zero, all, ix, base, 4));
+    }
+
+    expand_rgba_avx2(indices.subspan(i), table, target.subspan(i));
+  }
+  //NOLINTEND(*-reinterpret-cast,*-pointer-arithmetic)
+#endif
+
+
+
+
+
+  using expand_kernel = void(std::span<const pixglot::u8>, const palette_table&,
+                             std::span<pixglot::rgba<pixglot::u8>>);
+
+  expand_kernel* const expand_rgba =
+    pixglot::details::select_kernel<expand_kernel>("expand_palette<rgba>", {
+#if defined(__x86_64__) || defined(__i386__)
+      {pixglot::details::instruction_set::avx512bw, expand_rgba_avx512bw},
+      {pixglot::details::instruction_set::avx2,     expand_rgba_avx2},
+#endif
+      {pixglot::details::instruction_set::generic,  expand_rgba_scalar},
+    });
+
+
+
+  void expand_rgb(
+      std::span<const pixglot::u8>         indices,
+      const palette_table&                 table,
+      std::span<pixglot::rgb<pixglot::u8>> target
+  ) {
+    std::ranges::transform(indices, target.begin(), [&table](auto ix) {
+        const auto& color = table[ix]; //NOLINT(*-constant-array-index)
+        return pixglot::rgb<pixglot::u8>{.r = color.r, .g = color.g, .b = color.b};
+    });
+  }
+}
+
+
+
+
+
+namespace pixglot::details {
+  [[nodiscard]] pixel_buffer expand_palette(const indexed_buffer& source) {
+    const auto& indices = source.indices();
+    const auto& table   = source.lookup_table();
+
+    pixel_buffer target{source.width(), source.height(), source.format()};
+
+    for (size_t y = 0; y < source.height(); ++y) {
+      auto row = utils::interpret_as<const u8>(indices.row_bytes(y));
+
+      if (source.format().channels == color_channels::rgba) {
+        expand_rgba(row, table, target.row<rgba<u8>>(y));
+      } else {
+        expand_rgb(row, table, target.row<rgb<u8>>(y));
+      }
+    }
+
+    return target;
+  }
+}
@@ -4,6 +4,9 @@
 #include "pixglot/pixel-format-conversion.hpp"
 #include "pixglot/utils/cast.hpp"
 
+#include <algorithm>
+#include <array>
+
 using namespace pixglot;
 
 
@@ -11,6 +14,10 @@ using namespace pixglot;
 namespace pixglot::details {
   [[nodiscard]] std::endian swap_endian(std::endian);
   void swap_bytes(std::span<std::byte>, size_t);
+  void swap_bytes(std::span<const std::byte>, std::span<std::byte>, size_t);
+
+  void convert_f16_to_f32(std::span<const f16>, std::span<f32>);
+  void convert_f32_to_f16(std::span<const f32>, std::span<f16>);
 }
 
 
@@ -27,19 +34,9 @@ namespace {
 
 
   [[nodiscard]] bool is_arithmetic_conversion(data_format df1, data_format df2) {
+    // Byte swaps are fused into the loads and stores of convert_data_format,
+    // so a conversion in non-native endian costs no extra pass over the data.
     return df1 != df2;
-    /* FIXME: conversions between u8, u16, and u32
-     * can also be done efficiently in non-native endian
-
-    if (df1 == df2) {
-      return false;
-    }
-
-    if (is_float(df1) || is_float(df2)) {
-      return true;
-    }
-
-    return false;*/
   }
 
 
@@ -192,10 +189,54 @@ namespace {
 
 
 
+  template<data_format_type Src, data_format_type Tgt>
+  void convert_data_format(std::span<const Src> src, std::span<Tgt> tgt) {
+    if constexpr (std::is_same_v<Src, f16> && std::is_same_v<Tgt, f32>) {
+      details::convert_f16_to_f32(src, tgt);
+    } else if constexpr (std::is_same_v<Src, f32> && std::is_same_v<Tgt, f16>) {
+      details::convert_f32_to_f16(src, tgt);
+    } else {
+      for (size_t i = 0; i < src.size(); ++i) {
+        tgt[i] = data_format_cast<Tgt>(src[i]);
+      }
+    }
+  }
+
+
+
+  // Conversions between f16 and integer formats take a detour over f32 so
+  // that the half-float part runs on the vectorized kernels. The chunk stays
+  // in L1 and yields bit-identical results to a direct data_format_cast.
+  template<data_format_type Src, data_format_type Tgt>
+  void convert_data_format_via_f32(std::span<const Src> src, std::span<Tgt> tgt) {
+    std::array<f32, 512> interim{};
+
+    for (size_t i = 0; i < src.size(); i += interim.size()) {
+      auto count = std::min(interim.size(), src.size() - i);
+      auto chunk = std::span{interim}.first(count);
+
+      convert_data_format<Src, f32>(src.subspan(i, count), chunk);
+      convert_data_format<f32, Tgt>(chunk, tgt.subspan(i, count));
+    }
+  }
+
+
+
+  struct swap_mode {
+    bool load {false};
+    bool store{false};
+  };
+
+
+
+  // Processes the row in chunks small enough to stay in L1: a chunk is
+  // byte-swapped while it is loaded, converted, and swapped back in place
+  // right after it was stored, which keeps this a single pass over the data.
   template<data_format_type Src, data_format_type Tgt>
   void convert_data_format(
       std::span<const std::byte> source_bytes,
-      std::span<std::byte>       target_bytes
+      std::span<std::byte>       target_bytes,
+      swap_mode                  swap
   ) {
     auto src = utils::interpret_as_greedy<const Src>(source_bytes);
     auto tgt = utils::interpret_as_greedy<Tgt>(target_bytes);
@@ -204,8 +245,32 @@ namespace {
       throw std::bad_cast{};
     }
 
-    for (size_t i = 0; i < src.size(); ++i) {
-      tgt[i] = data_format_cast<Tgt>(src[i]);
+    static constexpr bool half_float_detour =
+      (std::is_same_v<Src, f16> && std::is_integral_v<Tgt>) ||
+      (std::is_integral_v<Src>  && std::is_same_v<Tgt, f16>);
+
+    std::array<Src, 512> swapped{};
+
+    for (size_t i = 0; i < src.size(); i += swapped.size()) {
+      auto count  = std::min(swapped.size(), src.size() - i);
+      auto input  = src.subspan(i, count);
+      auto output = tgt.subspan(i, count);
+
+      if (swap.load) {
+        details::swap_bytes(std::as_bytes(input),
+            std::as_writable_bytes(std::span{swapped}), sizeof(Src));
+        input = std::span{swapped}.first(count);
+      }
+
+      if constexpr (half_float_detour) {
+        convert_data_format_via_f32<Src, Tgt>(input, output);
+      } else {
+        convert_data_format<Src, Tgt>(input, output);
+      }
+
+      if (swap.store) {
+        details::swap_bytes(std::as_writable_bytes(output), sizeof(Tgt));
+      }
     }
   }
 
@@ -215,11 +280,12 @@ namespace {
   void convert_data_format(
       std::span<const std::byte> source_bytes,
       data_format                source_format,
-      std::span<std::byte>       target_bytes
+      std::span<std::byte>       target_bytes,
+      swap_mode                  swap
   ) {
     //NOLINTNEXTLINE(*macro*)
     #define CASE(x) case data_format::x: \
-      convert_data_format<x, Tgt>(source_bytes, target_bytes); \
+      convert_data_format<x, Tgt>(source_bytes, target_bytes, swap); \
       return;
 
     switch (source_format) {
@@ -244,11 +310,12 @@ namespace {
       std::span<const std::byte> source_bytes,
       data_format                source_format,
       std::span<std::byte>       target_bytes,
-      data_format                target_format
+      data_format                target_format,
+      swap_mode                  swap
   ) {
     //NOLINTNEXTLINE(*macro*)
     #define CASE(x) case data_format::x: \
-      convert_data_format<x>(source_bytes, source_format, target_bytes); \
+      convert_data_format<x>(source_bytes, source_format, target_bytes, swap); \
       return;
 
     switch (target_format) {
@@ -283,21 +350,14 @@ namespace {
       auto source_bytes = input.row_bytes(y);
       auto target_bytes = output.row_bytes(y);
 
-      if (pre_swap) {
-        details::swap_bytes(source_bytes, byte_size(input.format().format));
-      }
-
       size_t interim_size = output.width()
         * byte_size(target_format.format) * n_channels(input.format().channels);
 
       auto buffer_bytes = target_bytes.subspan(target_bytes.size() - interim_size);
 
       convert_data_format(source_bytes, input.format().format,
-                          buffer_bytes, target_format.format);
-
-      if (post_swap) {
-        details::swap_bytes(buffer_bytes, byte_size(target_format.format));
-      }
+                          buffer_bytes, target_format.format,
+                          swap_mode{.load = pre_swap, .store = post_swap});
 
       convert_color_channels(buffer_bytes, input.format().channels,
           target_bytes, target_format, post_swap);
@@ -305,6 +365,71 @@ namespace {
 
     input = std::move(output);
   }
+
+
+
+  // Converts chunks of pixels through scratch space in the same allocation. Front to
+  // back, a target chunk never reaches source data which is still to be read as long as
+  // neither pixel size nor stride grows; growing pixels are converted back to front,
+  // which requires the stride to stay the same.
+  void convert_pixel_format_in_place(
+      pixel_buffer& pixels,
+      bool          pre_swap,
+      pixel_format  target_format,
+      bool          post_swap
+  ) {
+    auto source_format = pixels.format();
+    auto source_stride = pixels.stride();
+    auto bytes         = pixels.data();
+
+    pixels.reinterpret(target_format);
+
+    auto target_stride = pixels.stride();
+
+    size_t width        = pixels.width();
+    size_t source_size  = source_format.size();
+    size_t target_size  = target_format.size();
+    size_t interim_size = byte_size(target_format.format) * n_channels(source_format.channels);
+
+    static constexpr size_t chunk = 256;
+    static constexpr size_t max_pixel_size = 16;
+
+    alignas(max_pixel_size) std::array<std::byte, chunk * max_pixel_size> source_chunk{};
+    alignas(max_pixel_size) std::array<std::byte, chunk * max_pixel_size> interim_chunk{};
+
+    bool   backward = target_size > source_size;
+    size_t chunks   = (width + chunk - 1) / chunk;
+
+    swap_mode swap{.load = pre_swap, .store = post_swap};
+
+    for (size_t y = 0; y < pixels.height(); ++y) {
+      auto source_row = bytes.subspan(y * source_stride, width * source_size);
+      auto target_row = bytes.subspan(y * target_stride, width * target_size);
+
+      for (size_t c = 0; c < chunks; ++c) {
+        size_t i     = (backward ? chunks - 1 - c : c) * chunk;
+        size_t count = std::min(chunk, width - i);
+
+        auto source = std::span{source_chunk}.first(count * source_size);
+        std::ranges::copy(source_row.subspan(i * source_size, source.size()), source.begin());
+
+        auto target = target_row.subspan(i * target_size, count * target_size);
+
+        if (source_format.channels == target_format.channels) {
+          convert_data_format(source, source_format.format,
+                              target, target_format.format, swap);
+        } else {
+          auto interim = std::span{interim_chunk}.first(count * interim_size);
+
+          convert_data_format(source, source_format.format,
+                              interim, target_format.format, swap);
+
+          convert_color_channels(interim, source_format.channels,
+              target, target_format, post_swap);
+        }
+      }
+    }
+  }
 }
 
 
@@ -343,7 +468,18 @@ void pixglot::convert_pixel_format(
     track_endian = details::swap_endian(track_endian);
   }
 
-  ::convert_pixel_format(input, needs_pre_swap, target_format, needs_post_swap);
+  // Shared storage is converted into a new buffer, which leaves the other buffers
+  // intact. Growing pixels are written back to front within a row, rows at a smaller
+  // stride than the source (e.g. orphaned sub buffers) would overwrite unread ones.
+  auto target_stride = pixel_buffer::stride_for_width(input.width(), target_format);
+  bool in_place = target_format.size() > input.format().size() ?
+    target_stride == input.stride() : target_stride <= input.stride();
+
+  if (!input.shares_storage() && in_place) {
+    convert_pixel_format_in_place(input, needs_pre_swap, target_format, needs_post_swap);
+  } else {
+    ::convert_pixel_format(input, needs_pre_swap, target_format, needs_post_swap);
+  }
 
   input.endian(track_endian);
 }
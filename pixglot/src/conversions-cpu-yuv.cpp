@@ -0,0 +1,134 @@
+#include "pixglot/details/yuv-coefficients.hpp"
+#include "pixglot/pixel-buffer.hpp"
+#include "pixglot/utils/cast.hpp"
+#include "pixglot/yuv-buffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <utility>
+#include <vector>
+
+
+
+namespace {
+  // Triangle filter for chroma sited between two luma samples, the same weights as
+  // the fancy upsampling of libjpeg.
+  [[nodiscard]] std::pair<size_t, size_t> upsample_neighbors(size_t x, size_t size) {
+    size_t near = std::min(x / 2, size - 1);
+
+    if (x % 2 == 0) {
+      return {near, near == 0 ? 0 : near - 1};
+    }
+    return {near, std::min(near + 1, size - 1)};
+  }
+
+
+
+  void upsample_row(std::span<const pixglot::u8> source, std::span<float> target) {
+    if (source.size() == target.size()) {
+      std::ranges::copy(source, target.begin());
+      return;
+    }
+
+    for (size_t x = 0; x < target.size(); ++x) {
+      auto [near, far] = upsample_neighbors(x, source.size());
+      //NOLINTNEXTLINE(*-magic-numbers)
+      target[x] = 0.75f * source[near] + 0.25f * source[far];
+    }
+  }
+
+
+
+  // horizontally upsampled chroma of one plane for the current luma row
+  class chroma_row {
+    public:
+      chroma_row(const pixglot::pixel_buffer& plane, size_t width) :
+        plane_{&plane},
+        near_ (width),
+        far_  (width)
+      {}
+
+
+
+      [[nodiscard]] std::span<const float> get(size_t y, bool half_y) {
+        if (!half_y) {
+          upsample_row(row(y), near_);
+          return near_;
+        }
+
+        auto [near, far] = upsample_neighbors(y, plane_->height());
+
+        upsample_row(row(near), near_);
+        upsample_row(row(far),  far_);
+
+        std::ranges::transform(near_, far_, near_.begin(), [](float n, float f) {
+            //NOLINTNEXTLINE(*-magic-numbers)
+            return 0.75f * n + 0.25f * f;
+        });
+
+        return near_;
+      }
+
+
+
+    private:
+      const pixglot::pixel_buffer* plane_;
+      std::vector<float>           near_;
+      std::vector<float>           far_;
+
+      [[nodiscard]] std::span<const pixglot::u8> row(size_t y) const {
+        return pixglot::utils::interpret_as<const pixglot::u8>(plane_->row_bytes(y));
+      }
+  };
+
+
+
+  [[nodiscard]] pixglot::u8 to_u8(float value) {
+    //NOLINTNEXTLINE(*-magic-numbers)
+    return static_cast<pixglot::u8>(std::clamp(std::round(value), 0.f, 255.f));
+  }
+}
+
+
+
+
+
+namespace pixglot::details {
+  [[nodiscard]] pixel_buffer expand_yuv(const yuv_buffer& source) {
+    pixel_buffer target{source.width(), source.height(), rgb<u8>::format()};
+
+    if (source.empty() || source.width() == 0 || source.height() == 0) {
+      return target;
+    }
+
+    const auto coeffs = yuv_to_rgb(source.matrix(), source.full_range());
+    const bool half_y = source.subsampling() == chroma_subsampling::cs420;
+
+    chroma_row cb{source.u(), source.width()};
+    chroma_row cr{source.v(), source.width()};
+
+    for (size_t y = 0; y < source.height(); ++y) {
+      auto luma   = utils::interpret_as<const u8>(source.y().row_bytes(y));
+      auto blue   = cb.get(y, half_y);
+      auto red    = cr.get(y, half_y);
+      auto output = target.row<rgb<u8>>(y);
+
+      for (size_t x = 0; x < source.width(); ++x) {
+        float l = (static_cast<float>(luma[x]) - coeffs.y_offset) * coeffs.y_scale;
+        //NOLINTBEGIN(*-magic-numbers)
+        float u = (blue[x] - 128.f) * coeffs.c_scale;
+        float v = (red[x]  - 128.f) * coeffs.c_scale;
+        //NOLINTEND(*-magic-numbers)
+
+        output[x] = rgb<u8> {
+          .r = to_u8(l + coeffs.cr_r * v),
+          .g = to_u8(l + coeffs.cb_g * u + coeffs.cr_g * v),
+          .b = to_u8(l + coeffs.cb_b * u),
+        };
+      }
+    }
+
+    return target;
+  }
+}
@@ -1,32 +1,169 @@
 #include "pixglot/conversions.hpp"
+#include "pixglot/details/fused-conversion.hpp"
+#include "pixglot/details/transfer-functions.hpp"
+#include "pixglot/exception.hpp"
+#include "pixglot/image-view.hpp"
 #include "pixglot/pixel-buffer.hpp"
 #include "pixglot/pixel-format.hpp"
+#include "pixglot/pixel-format-conversion.hpp"
 #include "pixglot/square-isometry.hpp"
+#include "pixglot/utils/cast.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
 
 using namespace pixglot;
 
 
 
+namespace pixglot::details {
+  void swap_bytes(std::span<std::byte>, size_t);
+  void convert_f16_to_f32(std::span<const f16>, std::span<f32>);
+}
+
+
+
 
 namespace {
+  // Applies the gamma to the color channels of a row of f32 samples, four at a time.
+  // Each chunk starts at a pixel boundary, so the alpha lanes are the same in every chunk.
   template<pixel_type T>
     requires std::is_same_v<typename T::component, f32>
-  void apply_gamma_correction(T& pix, float exp) {
-    if constexpr (has_color(T::format().channels)) {
-      pix.r = std::pow(pix.r, exp);
-      pix.g = std::pow(pix.g, exp);
-      pix.b = std::pow(pix.b, exp);
-    } else {
-      pix.v = std::pow(pix.v, exp);
+  void apply_gamma_correction(std::span<T> row, const details::gamma_transfer& gamma) {
+    using details::f32x4;
+    using details::i32x4;
+
+    static constexpr size_t channels = n_channels(T::format().channels);
+
+    i32x4 alpha{};
+    if constexpr (has_alpha(T::format().channels)) {
+      for (size_t i = 0; i < 4; ++i) {
+        alpha[i] = (i % channels == channels - 1) ? -1 : 0;
+      }
+    }
+
+    auto samples = utils::interpret_as_greedy<f32>(std::as_writable_bytes(row));
+
+    for (size_t i = 0; i < samples.size(); i += 4) {
+      auto count = std::min<size_t>(4, samples.size() - i);
+
+      f32x4 values = details::broadcast(1.f);
+      std::ranges::copy_n(samples.begin() + i, count, &values[0]);
+
+      values = alpha ? values : gamma.apply(values);
+
+      std::ranges::copy_n(&values[0], count, samples.begin() + i);
+    }
+  }
+
+
+
+  [[nodiscard]] bool needs_gamma_correction(const details::gamma_transfer& gamma) {
+    return gamma.function != details::gamma_transfer::curve::power ||
+      std::abs(gamma.exponent - 1.f) > 1e-2f;
+  }
+
+
+
+
+
+  // Maps every possible raw channel value to its gamma corrected value.
+  // For buffers in non-native endian, index and entries are byte-swapped as well,
+  // so that the table can be applied without touching the endian of the buffer.
+  template<std::unsigned_integral T>
+  [[nodiscard]] std::vector<T> create_gamma_table(
+      const details::gamma_transfer& gamma,
+      bool                           swapped
+  ) {
+    std::vector<T> table(static_cast<size_t>(std::numeric_limits<T>::max()) + 1);
+
+    for (size_t i = 0; i < table.size(); ++i) {
+      auto value = static_cast<T>(i);
+      if (swapped) {
+        value = std::byteswap(value);
+      }
+
+      // exact pow, the table is computed once per conversion
+      auto input  = data_format_cast<f32>(value);
+      auto output = gamma.function == details::gamma_transfer::curve::power ?
+        std::pow(input, gamma.exponent) : gamma.apply(details::broadcast(input))[0];
+
+      auto result = data_format_cast<T>(output);
+      if (swapped) {
+        result = std::byteswap(result);
+      }
+
+      table[i] = result;
+    }
+
+    return table;
+  }
+
+
+
+  template<pixel_type T>
+  void apply_gamma_table(pixel_buffer& pixels, std::span<const typename T::component> table) {
+    for (auto row: image_view<T>{pixels}.rows()) {
+      for (auto& pix: row) {
+        if constexpr (has_color(T::format().channels)) {
+          pix.r = table[pix.r];
+          pix.g = table[pix.g];
+          pix.b = table[pix.b];
+        } else {
+          pix.v = table[pix.v];
+        }
+      }
+    }
+  }
+
+
+
+  template<std::unsigned_integral D>
+  void apply_gamma_table(pixel_buffer& pixels, const details::gamma_transfer& gamma) {
+    auto table = create_gamma_table<D>(gamma, pixels.endian() != std::endian::native);
+
+    pixels.unshare();
+
+    switch (pixels.format().channels) {
+      case color_channels::gray:   apply_gamma_table<gray  <D>>(pixels, table); break;
+      case color_channels::gray_a: apply_gamma_table<gray_a<D>>(pixels, table); break;
+      case color_channels::rgb:    apply_gamma_table<rgb   <D>>(pixels, table); break;
+      case color_channels::rgba:   apply_gamma_table<rgba  <D>>(pixels, table); break;
     }
   }
 
 
 
-  [[nodiscard]] bool needs_gamma_correction(float exp) {
-    return std::abs(exp - 1.f) > 1e-2f;
+  // Gamma and alpha can be applied in the integer domain of u8 and u16 pixels
+  // unless the target is float or wider, which would lose the precision of the f32 detour.
+  [[nodiscard]] bool keeps_integer_precision(data_format source, data_format target) {
+    return (source == data_format::u8 || source == data_format::u16)
+      && !is_float(target) && byte_size(target) <= byte_size(source);
+  }
+
+
+
+  [[nodiscard]] bool use_gamma_table(const pixel_buffer& pixels) {
+    auto format = pixels.format().format;
+
+    if (format == data_format::u8) {
+      return true;
+    }
+
+    if (format == data_format::u16) {
+      // only worth it if the 64k entry table is amortized over enough samples
+      auto color_samples = n_channels(pixels.format().channels)
+                           - (has_alpha(pixels.format().channels) ? 1 : 0);
+      return pixels.width() * pixels.height() * color_samples >= (size_t{1} << 18);
+    }
+
+    return false;
   }
 
 
@@ -44,7 +181,7 @@ namespace {
             pix.g /= pix.a;
             pix.b /= pix.a;
           } else {
-            pix.v /= pix.v;
+            pix.v /= pix.a;
           }
         }
       } else if constexpr (Pre > 0) {
@@ -53,45 +190,231 @@ namespace {
           pix.g *= pix.a;
           pix.b *= pix.a;
         } else {
-          pix.v *= pix.v;
+          pix.v *= pix.a;
         }
       }
     }
   }
+}
 
 
 
 
 
-  template<pixel_type T>
-    requires std::is_same_v<typename T::component, f32>
-  void apply_transforms(pixel_buffer& input, float exp, bool gc, int pre) {
-    for (size_t y = 0; y < input.height(); ++y) {
-      auto row = input.row<T>(y);
+namespace {
+  template<data_format_type D, data_format_type S> gray  <D> rebind_component(gray  <S>);
+  template<data_format_type D, data_format_type S> gray_a<D> rebind_component(gray_a<S>);
+  template<data_format_type D, data_format_type S> rgb   <D> rebind_component(rgb   <S>);
+  template<data_format_type D, data_format_type S> rgba  <D> rebind_component(rgba  <S>);
+
+  template<pixel_type P, data_format_type D>
+  using with_component = decltype(rebind_component<D>(std::declval<P>()));
+
+
+
+  [[nodiscard]] constexpr bool castable(color_channels source, color_channels target) {
+    auto i1 = n_channels(source) - 1;
+    auto i2 = n_channels(target) - 1;
+
+    return (i1 & 1) <= (i2 & 1) && (i1 & 2) <= (i2 & 2);
+  }
+
+
+
+
+
+  // The source pixel of target pixel (x, y) is at origin + x * step_x + y * step_y
+  struct source_walk {
+    const std::byte* origin;
+    ptrdiff_t        step_x;
+    ptrdiff_t        step_y;
+  };
+
+
+
+  [[nodiscard]] source_walk walk_for(const pixel_buffer& source, square_isometry transform) {
+    auto w = static_cast<ptrdiff_t>(source.width())  - 1;
+    auto h = static_cast<ptrdiff_t>(source.height()) - 1;
+
+    // source coordinates of the first target pixel and their change along target x and y
+    struct {
+      ptrdiff_t x0, y0;
+      ptrdiff_t xx, yx;
+      ptrdiff_t xy, yy;
+    } m{};
+
+    switch (transform) {
+      case square_isometry::identity:       m = {0, 0,   1,  0,   0,  1}; break;
+      case square_isometry::flip_x:         m = {w, 0,  -1,  0,   0,  1}; break;
+      case square_isometry::flip_y:         m = {0, h,   1,  0,   0, -1}; break;
+      case square_isometry::rotate_half:    m = {w, h,  -1,  0,   0, -1}; break;
+      case square_isometry::transpose:      m = {0, 0,   0,  1,   1,  0}; break;
+      case square_isometry::rotate_cw:      m = {0, h,   0, -1,   1,  0}; break;
+      case square_isometry::rotate_ccw:     m = {w, 0,   0,  1,  -1,  0}; break;
+      case square_isometry::anti_transpose: m = {w, h,   0, -1,  -1,  0}; break;
+    }
+
+    auto pixel = static_cast<ptrdiff_t>(source.format().size());
+    auto row   = source.signed_stride();
+
+    return source_walk {
+      //NOLINTNEXTLINE(*-pointer-arithmetic)
+      .origin = source.row_bytes(0).data() + m.x0 * pixel + m.y0 * row,
+      .step_x = m.xx * pixel + m.yx * row,
+      .step_y = m.xy * pixel + m.yy * row
+    };
+  }
+
+
+
+
+
+  // Converts target rows in blocks which stay in L1: gather the source pixels of a block
+  // in target order, swap them to native endian, apply gamma and alpha in f32 if required,
+  // cast to the target pixel type directly into the target row and swap that if required.
+  template<pixel_type Src, pixel_type Tgt>
+  void fused_kernel(
+      const details::fused_conversion::parameters& params,
+      const pixel_buffer&                          source,
+      pixel_buffer&                                target
+  ) {
+    using Interim = with_component<Src, f32>;
+
+    static constexpr size_t block = 64;
+
+    std::array<Src,     block> src{};
+    std::array<Interim, block> interim{};
+
+    auto walk = walk_for(source, params.transform);
+
+    image_view<Tgt> output_view{target};
 
-      if (gc) {
-        for (auto& pix: row) {
-          apply_gamma_correction(pix, exp);
+    bool swap_source = params.swap_source();
+    bool swap_target = params.swap_target();
+    bool gc          = params.gamma_correction();
+    bool f32_stage   = gc || params.premultiply != 0;
+
+    // for transposing rotations, neighboring target rows read neighboring source pixels
+    size_t band = flips_xy(params.transform) ? 16 : 1;
+
+    //NOLINTBEGIN(*-pointer-arithmetic)
+    for (size_t y0 = 0; y0 < target.height(); y0 += band) {
+      size_t y1 = std::min(y0 + band, target.height());
+
+      for (size_t x = 0; x < target.width(); x += block) {
+        size_t count = std::min(block, target.width() - x);
+
+        for (size_t y = y0; y < y1; ++y) {
+          const auto* pixel = walk.origin
+            + static_cast<ptrdiff_t>(x) * walk.step_x
+            + static_cast<ptrdiff_t>(y) * walk.step_y;
+
+          auto input = std::span{src}.first(count);
+
+          if (walk.step_x == static_cast<ptrdiff_t>(sizeof(Src))) {
+            std::memcpy(input.data(), pixel, input.size_bytes());
+          } else {
+            for (auto& pix: input) {
+              std::memcpy(&pix, pixel, sizeof(Src));
+              pixel += walk.step_x;
+            }
+          }
+
+          if (swap_source) {
+            details::swap_bytes(std::as_writable_bytes(input), sizeof(typename Src::component));
+          }
+
+          auto output = output_view.row(y).subspan(x, count);
+
+          if (f32_stage) {
+            auto values = std::span{interim}.first(count);
+
+            if constexpr (std::is_same_v<typename Src::component, f16>) {
+              details::convert_f16_to_f32(
+                  utils::interpret_as_greedy<const f16>(std::as_bytes(input)),
+                  utils::interpret_as_greedy<f32>(std::as_writable_bytes(values)));
+            } else {
+              std::ranges::transform(input, values.begin(), pixel_cast<Interim, Src>);
+            }
+
+            if (gc) {
+              apply_gamma_correction(values, params.gamma);
+            }
+
+            if (params.premultiply < 0) {
+              std::ranges::for_each(values, apply_alpha_conversion<Interim, -1>);
+            } else if (params.premultiply > 0) {
+              std::ranges::for_each(values, apply_alpha_conversion<Interim, 1>);
+            }
+
+            std::ranges::transform(values, output.begin(), pixel_cast<Tgt, Interim>);
+          } else {
+            std::ranges::transform(input, output.begin(), pixel_cast<Tgt, Src>);
+          }
+
+          if (swap_target) {
+            details::swap_bytes(std::as_writable_bytes(output), sizeof(typename Tgt::component));
+          }
         }
       }
+    }
+    //NOLINTEND(*-pointer-arithmetic)
+  }
 
-      if (pre < 0) {
-        std::ranges::for_each(row, apply_alpha_conversion<T, -1>);
-      } else if (pre > 0) {
-        std::ranges::for_each(row, apply_alpha_conversion<T, 1>);
-      }
+
+
+
+
+  template<data_format_type D, typename Fn>
+  [[nodiscard]] auto visit_pixel_type(color_channels channels, Fn&& fn) {
+    switch (channels) {
+      case color_channels::gray:   return fn(std::type_identity<gray  <D>>{});
+      case color_channels::gray_a: return fn(std::type_identity<gray_a<D>>{});
+      case color_channels::rgb:    return fn(std::type_identity<rgb   <D>>{});
+      case color_channels::rgba:   return fn(std::type_identity<rgba  <D>>{});
     }
+
+    throw base_exception{"Invalid color channels", to_string(channels) + " is not supported"};
   }
 
 
 
-  void apply_transforms(pixel_buffer& in, float exp, bool gc, int pre) {
-    switch (in.format().channels) {
-      case color_channels::gray:   apply_transforms<gray  <f32>>(in, exp, gc, pre); break;
-      case color_channels::gray_a: apply_transforms<gray_a<f32>>(in, exp, gc, pre); break;
-      case color_channels::rgb:    apply_transforms<rgb   <f32>>(in, exp, gc, pre); break;
-      case color_channels::rgba:   apply_transforms<rgba  <f32>>(in, exp, gc, pre); break;
+  template<typename Fn>
+  [[nodiscard]] auto visit_pixel_type(pixel_format format, Fn&& fn) {
+    switch (format.format) {
+      case data_format::u8:  return visit_pixel_type<u8> (format.channels, fn);
+      case data_format::u16: return visit_pixel_type<u16>(format.channels, fn);
+      case data_format::u32: return visit_pixel_type<u32>(format.channels, fn);
+      case data_format::f16: return visit_pixel_type<f16>(format.channels, fn);
+      case data_format::f32: return visit_pixel_type<f32>(format.channels, fn);
     }
+
+    throw bad_pixel_format{format};
+  }
+
+
+
+  [[nodiscard]] details::fused_conversion::kernel* select_fused_kernel(
+      pixel_format source,
+      pixel_format target
+  ) {
+    using kernel = details::fused_conversion::kernel;
+
+    auto* selected = visit_pixel_type(source, [target]<pixel_type Src>(std::type_identity<Src>) {
+      return visit_pixel_type(target, []<pixel_type Tgt>(std::type_identity<Tgt>) -> kernel* {
+        if constexpr (castable(Src::format().channels, Tgt::format().channels)) {
+          return fused_kernel<Src, Tgt>;
+        } else {
+          return nullptr;
+        }
+      });
+    });
+
+    if (selected == nullptr) {
+      throw bad_pixel_format{target};
+    }
+
+    return selected;
   }
 }
 
@@ -101,6 +424,103 @@ namespace {
 
 namespace pixglot::details {
   void apply_orientation(pixel_buffer&, square_isometry);
+  void convert_alpha_integer(pixel_buffer&, int);
+
+
+
+  bool fused_conversion::parameters::swap_source() const {
+    return byte_size(source_format.format) > 1 && source_endian != std::endian::native;
+  }
+
+
+
+  bool fused_conversion::parameters::swap_target() const {
+    return byte_size(target_format.format) > 1 && target_endian != std::endian::native;
+  }
+
+
+
+  bool fused_conversion::parameters::gamma_correction() const {
+    return needs_gamma_correction(gamma);
+  }
+
+
+
+  fused_conversion::fused_conversion(
+      pixel_format               source_format,
+      std::endian                source_endian,
+      pixel_format               target_format,
+      std::optional<std::endian> target_endian,
+      int                        premultiply,
+      gamma_transfer             gamma,
+      square_isometry            transform
+  ) :
+    params_{
+      .source_format = source_format,
+      .source_endian = source_endian,
+      .target_format = target_format,
+      .target_endian = target_endian.value_or(std::endian::native),
+      .premultiply   = premultiply,
+      .gamma         = gamma,
+      .transform     = transform
+    },
+    kernel_{select_fused_kernel(source_format, target_format)}
+  {}
+
+
+
+  pixel_buffer fused_conversion::apply(const pixel_buffer& source) const {
+    if (source.format() != params_.source_format) {
+      throw bad_pixel_format{source.format()};
+    }
+
+    if (byte_size(source.format().format) > 1 && source.endian() != params_.source_endian) {
+      throw base_exception{"Endian mismatch",
+        "fused_conversion was created for a source of different endian"};
+    }
+
+    size_t width {source.width()};
+    size_t height{source.height()};
+
+    if (flips_xy(params_.transform)) {
+      std::swap(width, height);
+    }
+
+    pixel_buffer target{width, height, params_.target_format, params_.target_endian};
+
+    if (width > 0 && height > 0) {
+      kernel_(params_, source, target);
+    }
+
+    return target;
+  }
+
+
+
+  std::optional<fused_conversion> select_fused_conversion(
+      pixel_format               source_format,
+      std::endian                source_endian,
+      pixel_format               target_format,
+      std::optional<std::endian> target_endian,
+      int                        premultiply,
+      gamma_transfer             gamma,
+      square_isometry            transform
+  ) {
+    bool gamma_correction = needs_gamma_correction(gamma);
+
+    if (keeps_integer_precision(source_format.format, target_format.format)
+        && (gamma_correction || premultiply != 0)) {
+      return {};
+    }
+
+    if (gamma_correction || premultiply != 0
+        || (source_format != target_format && transform != square_isometry::identity)) {
+      return fused_conversion{source_format, source_endian, target_format, target_endian,
+        premultiply, gamma_correction ? gamma : gamma_transfer{}, transform};
+    }
+
+    return {};
+  }
 
 
 
@@ -109,32 +529,48 @@ namespace pixglot::details {
       std::optional<std::endian> target_endian,
       pixel_format               target_format,
       int                        premultiply,
-      float                      gamma_exp,
+      gamma_transfer             gamma,
       square_isometry            transform
   ) {
-    if (transform != square_isometry::identity
-        && pixels.format().size() < target_format.size()) {
-      apply_orientation(pixels, transform);
-      transform = square_isometry::identity;
+    bool gamma_correction = needs_gamma_correction(gamma);
+
+    if (keeps_integer_precision(pixels.format().format, target_format.format)) {
+      if (gamma_correction && use_gamma_table(pixels)) {
+        if (pixels.format().format == data_format::u8) {
+          apply_gamma_table<u8>(pixels, gamma);
+        } else {
+          apply_gamma_table<u16>(pixels, gamma);
+        }
+        gamma_correction = false;
+      }
+
+      if (!gamma_correction && premultiply != 0
+          && (pixels.format().format == data_format::u8
+              || pixels.endian() == std::endian::native)) {
+        convert_alpha_integer(pixels, premultiply);
+        premultiply = 0;
+      }
     }
 
-    bool gamma_correction = needs_gamma_correction(gamma_exp);
 
-    if (gamma_correction || premultiply != 0) {
-      convert_pixel_format(pixels, pixel_format {
-          .format   = data_format::f32,
-          .channels = pixels.format().channels
-      }, std::endian::native);
 
-      apply_transforms(pixels, gamma_exp, gamma_correction, premultiply);
+    bool reformat = pixels.format() != target_format;
+    bool reorient = transform != square_isometry::identity;
+
+    if (gamma_correction || premultiply != 0 || (reformat && reorient)) {
+      fused_conversion conversion{pixels.format(), pixels.endian(), target_format,
+        target_endian, premultiply, gamma_correction ? gamma : gamma_transfer{},
+        transform};
+
+      pixels = conversion.apply(pixels);
+      return;
     }
 
 
 
     convert_pixel_format(pixels, target_format, target_endian);
 
-
-    if (transform != square_isometry::identity) {
+    if (reorient) {
       apply_orientation(pixels, transform);
     }
   }
@@ -1,62 +1,27 @@
 #include <epoxy/gl.h>
 #include <epoxy/gl_generated.h>
 
+#include "pixglot/conversions.hpp"
+#include "pixglot/details/transfer-functions.hpp"
+#include "pixglot/details/yuv-coefficients.hpp"
 #include "pixglot/exception.hpp"
 #include "pixglot/gl-texture.hpp"
+#include "pixglot/indexed-buffer.hpp"
+#include "pixglot/pixel-buffer.hpp"
 #include "pixglot/pixel-format.hpp"
 #include "pixglot/square-isometry.hpp"
 #include "pixglot/utils/int_cast.hpp"
+#include "pixglot/yuv-buffer.hpp"
 
-
-
-namespace {
-  [[nodiscard]] GLuint generate_framebuffer() {
-    GLuint name{0};
-    glGenFramebuffers(1, &name);
-    if (name == 0) {
-      throw pixglot::base_exception{"unable to create glFramebuffer"};
-    }
-    return name;
-  }
-
-
-
-  class framebuffer {
-    public:
-      framebuffer(const pixglot::gl_texture& texture) :
-        id_          {generate_framebuffer()},
-        binding_lock_{&id_}
-      {
-        glBindFramebuffer(GL_FRAMEBUFFER, id_);
-
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
-            GL_TEXTURE_2D, texture.id(), 0);
-
-        static constexpr std::array<GLenum, 1> draw_buffers = {GL_COLOR_ATTACHMENT0};
-        glDrawBuffers(draw_buffers.size(), draw_buffers.data());
-
-        if (auto res = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-            res != GL_FRAMEBUFFER_COMPLETE) {
-          throw pixglot::base_exception{"failed to initialize glFramebuffer"};
-        }
-      }
-
-
-
-    private:
-      GLuint id_{0};
-
-      struct framebuffer_deleter {
-        void operator()(GLuint* /*placeholder*/) {
-          glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        }
-      };
-
-      std::unique_ptr<GLuint, framebuffer_deleter> binding_lock_;
-  };
+#include <algorithm>
+#include <array>
+#include <span>
+#include <string>
+#include <unordered_map>
 
 
 
+namespace {
   class shader {
     public:
       shader(const shader&)            = delete;
@@ -89,125 +54,263 @@ namespace {
 
 
 
-  class program {
-    public:
-      program(const program&)            = delete;
-      program(program&&)                 = delete;
-      program& operator=(const program&) = delete;
-      program& operator=(program&&)      = delete;
+  [[nodiscard]] GLuint link_program(std::string_view vs, std::string_view fs) {
+    GLuint program = glCreateProgram();
 
-      program(std::string_view vs, std::string_view fs) :
-        program_{glCreateProgram()} {
-        shader vertex  {GL_VERTEX_SHADER,   vs};
-        glAttachShader(program_, vertex.get());
+    shader vertex  {GL_VERTEX_SHADER,   vs};
+    glAttachShader(program, vertex.get());
 
-        shader fragment{GL_FRAGMENT_SHADER, fs};
-        glAttachShader(program_, fragment.get());
+    shader fragment{GL_FRAGMENT_SHADER, fs};
+    glAttachShader(program, fragment.get());
 
-        glLinkProgram(program_);
+    glLinkProgram(program);
 
-        GLint status{GL_FALSE};
-        glGetProgramiv(program_, GL_LINK_STATUS, &status);
-        if (status == GL_FALSE || program_ == 0) {
-          glDeleteProgram(program_);
-          throw pixglot::base_exception{"unable to link program"};
-        }
+    GLint status{GL_FALSE};
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE || program == 0) {
+      glDeleteProgram(program);
+      throw pixglot::base_exception{"unable to link program"};
+    }
 
-        glDetachShader(program_, vertex.get());
-        glDetachShader(program_, fragment.get());
-      }
+    glDetachShader(program, vertex.get());
+    glDetachShader(program, fragment.get());
 
-      void use() const { glUseProgram(program_); }
+    return program;
+  }
 
-      ~program() { glDeleteProgram(program_); }
 
 
+  struct quad {
+    static constexpr std::array<GLushort, 6> indices {
+      0, 1, 2,
+      1, 2, 3,
+    };
 
-    private:
-      GLuint program_{0};
+    static constexpr std::array<GLfloat, 16> vertices {
+      -1.f,  1.f, 0.f, 1.f,
+       1.f,  1.f, 0.f, 1.f,
+      -1.f, -1.f, 0.f, 1.f,
+       1.f, -1.f, 0.f, 1.f,
+    };
+
+    GLuint vao{0};
+    GLuint vbo{0};
+    GLuint ibo{0};
+  };
+
+
+
+  [[nodiscard]] quad create_quad() {
+    quad q;
+
+    glGenVertexArrays(1, &q.vao);
+    glBindVertexArray(q.vao);
+
+    glGenBuffers(1, &q.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, q.vbo);
+    glBufferData(GL_ARRAY_BUFFER,
+        std::span{quad::vertices}.size_bytes(), quad::vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &q.ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, q.ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+        std::span{quad::indices}.size_bytes(), quad::indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+
+    return q;
+  }
+
+
+
+
+
+  // specializations of the conversion shader, palette and yuv expansion have their
+  // own programs
+  struct shader_variant {
+    bool palette          {false};
+    bool yuv              {false};
+
+    bool source_uint      {false};
+    bool source_alpha     {true};
+    bool gamma            {false};
+    bool srgb_to_linear   {false};
+    bool linear_to_srgb   {false};
+    int  premultiply      {0};
+    bool target_gray_alpha{false};
+    bool target_uint      {false};
+
+    [[nodiscard]] unsigned int key() const {
+      return static_cast<unsigned int>(palette)
+        | static_cast<unsigned int>(source_uint)       << 1u
+        | static_cast<unsigned int>(source_alpha)      << 2u
+        | static_cast<unsigned int>(gamma)             << 3u
+        | static_cast<unsigned int>(premultiply + 1)   << 4u
+        | static_cast<unsigned int>(target_gray_alpha) << 6u
+        | static_cast<unsigned int>(target_uint)       << 7u
+        | static_cast<unsigned int>(yuv)               << 8u
+        | static_cast<unsigned int>(srgb_to_linear)    << 9u
+        | static_cast<unsigned int>(linear_to_srgb)    << 10u;
+    }
   };
 
+  [[nodiscard]] std::string_view vertex_shader();
+  [[nodiscard]] std::string      fragment_shader(const shader_variant&);
+
+
+
+  // set by pixglot::gl_context_key, nullptr if the current context is unknown
+  thread_local const void* current_context_key{nullptr};
+
 
 
-  class plane {
+  // Programs, quad and framebuffer of one context, see pixglot::gl_context_key.
+  // Nothing is deleted explicitly since no context may be current when the thread
+  // exits; the objects are released together with their context.
+  // Without a key, glIs* cannot tell our objects from those of another context with
+  // the same name. Framebuffer and quad are then created for each conversion and
+  // programs are recognized by their label.
+  class gl_cache {
     public:
-      static constexpr std::array<GLushort, 6> indices {
-        0, 1, 2,
-        1, 2, 3,
-      };
-
-      static constexpr std::array<GLfloat, 16> vertices {
-        -1.f,  1.f, 0.f, 1.f,
-         1.f,  1.f, 0.f, 1.f,
-        -1.f, -1.f, 0.f, 1.f,
-         1.f, -1.f, 0.f, 1.f,
-      };
-
-      [[nodiscard]] static GLuint generate_vertex_array() {
-        GLuint vao{0};
-        glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
-        return vao;
+      [[nodiscard]] static gl_cache& current() {
+        thread_local std::unordered_map<const void*, gl_cache> caches;
+        return caches.try_emplace(current_context_key,
+                                  current_context_key != nullptr).first->second;
       }
 
-      [[nodiscard]] static GLuint generate_vertex_buffer() {
-        GLuint vbo{0};
-        glGenBuffers(1, &vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER,
-            std::span{vertices}.size_bytes(), vertices.data(), GL_STATIC_DRAW);
-        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
-        glEnableVertexAttribArray(0);
 
-        return vbo;
-      }
 
-      [[nodiscard]] static GLuint generate_index_buffer() {
-        GLuint ibo{0};
-        glGenBuffers(1, &ibo);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            std::span{indices}.size_bytes(), indices.data(), GL_STATIC_DRAW);
-        return ibo;
+      explicit gl_cache(bool keyed) : keyed_{keyed} {}
+
+
+
+      void use(const shader_variant& variant) {
+        auto& program = programs_[variant.key()];
+
+        if (program == 0 || !owns_program(program, variant)) {
+          program = link_program(vertex_shader(), fragment_shader(variant));
+
+          auto label = program_label(variant);
+          glObjectLabel(GL_PROGRAM, program,
+              pixglot::utils::int_cast<GLsizei>(label.size()), label.data());
+        }
+
+        glUseProgram(program);
       }
 
 
 
-      plane(const plane&)            = delete;
-      plane(plane&&)                 = delete;
-      plane& operator=(const plane&) = delete;
-      plane& operator=(plane&&)      = delete;
+      // binds target as the only color attachment and sets the viewport
+      void bind_target(const pixglot::gl_texture& target) {
+        if (framebuffer_ == 0 || glIsFramebuffer(framebuffer_) == GL_FALSE) {
+          glGenFramebuffers(1, &framebuffer_);
+          if (framebuffer_ == 0) {
+            throw pixglot::base_exception{"unable to create glFramebuffer"};
+          }
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+            GL_TEXTURE_2D, target.id(), 0);
+
+        static constexpr std::array<GLenum, 1> draw_buffers = {GL_COLOR_ATTACHMENT0};
+        glDrawBuffers(draw_buffers.size(), draw_buffers.data());
 
-      plane() :
-        vao_{generate_vertex_array()},
-        vbo_{generate_vertex_buffer()},
-        ibo_{generate_index_buffer()}
-      {}
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+          release_target();
+          throw pixglot::base_exception{"failed to initialize glFramebuffer"};
+        }
 
-      ~plane() {
-        glDeleteBuffers(1, &ibo_);
-        glDeleteBuffers(1, &vbo_);
-        glDeleteVertexArrays(1, &vao_);
+        glViewport(0, 0, pixglot::utils::int_cast<GLsizei>(target.width()),
+                         pixglot::utils::int_cast<GLsizei>(target.height()));
       }
 
-      void draw() const {
-        glBindVertexArray(vao_);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_SHORT, nullptr);
+
+
+      // draws the quad into the bound target and releases it
+      void draw() {
+        if (quad_.vao == 0 || glIsVertexArray(quad_.vao) == GL_FALSE) {
+          quad_ = create_quad();
+        }
+
+        glBindVertexArray(quad_.vao);
+        glDrawElements(GL_TRIANGLES, quad::indices.size(), GL_UNSIGNED_SHORT, nullptr);
+        glBindVertexArray(0);
+
+        if (!keyed_) {
+          glDeleteVertexArrays(1, &quad_.vao);
+          glDeleteBuffers(1, &quad_.vbo);
+          glDeleteBuffers(1, &quad_.ibo);
+          quad_ = quad{};
+        }
+
+        release_target();
       }
 
 
 
     private:
-      GLuint vao_{0};
-      GLuint vbo_{0};
-      GLuint ibo_{0};
+      bool                                     keyed_;
+      std::unordered_map<unsigned int, GLuint> programs_;
+      GLuint                                   framebuffer_{0};
+      quad                                     quad_;
+
+
+
+      [[nodiscard]] static std::string program_label(const shader_variant& variant) {
+        return "pixglot conversion " + std::to_string(variant.key());
+      }
+
+
+
+      [[nodiscard]] bool owns_program(
+          GLuint                program,
+          const shader_variant& variant
+      ) const {
+        if (glIsProgram(program) == GL_FALSE) {
+          return false;
+        }
+        if (keyed_) {
+          return true;
+        }
+
+        auto expected = program_label(variant);
+        std::string label(expected.size() + 1, '\0');
+        GLsizei length{0};
+        glGetObjectLabel(GL_PROGRAM, program,
+            pixglot::utils::int_cast<GLsizei>(label.size()), &length, label.data());
+
+        return label.substr(0, length) == expected;
+      }
+
+
+
+      // an attachment would keep the target alive after its deletion
+      void release_target() {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (!keyed_) {
+          glDeleteFramebuffers(1, &framebuffer_);
+          framebuffer_ = 0;
+        }
+      }
   };
 }
 
 
 
+void pixglot::gl_context_key(const void* key) {
+  current_context_key = key;
+}
+
+
+
 namespace {
-constexpr std::string_view vertex_shader = R"(
+constexpr std::string_view vertex_shader_source = R"(
 #version 450 core
 
 layout (location=0) in vec4 position;
@@ -224,21 +327,172 @@ void main() {
 
 
 
-constexpr std::string_view fragment_shader = R"(
+constexpr std::string_view fragment_shader_version = R"(
 #version 450 core
+)";
+
 
-out vec4 fragColor;
 
+// Integer textures cannot be filtered and ignore the normalization of the other
+// formats, u32 data is read with texelFetch and scaled manually.
+constexpr std::string_view fragment_shader_main = R"(
 in vec2 uvCoord;
-uniform sampler2D textureSampler;
 
 layout (location=1) uniform vec4 exponent;
 
+#ifdef PIXGLOT_SOURCE_UINT
+uniform usampler2D textureSampler;
+
+vec4 source_color() {
+  ivec2 size  = textureSize(textureSampler, 0);
+  ivec2 coord = clamp(ivec2(uvCoord * vec2(size)), ivec2(0), size - ivec2(1));
+
+  vec4 color = vec4(texelFetch(textureSampler, coord, 0)) / 4294967295.0;
+#ifndef PIXGLOT_SOURCE_ALPHA
+  color.a = 1.0;
+#endif
+  return color;
+}
+#else
+uniform sampler2D textureSampler;
+
+vec4 source_color() {
+  return texture(textureSampler, uvCoord);
+}
+#endif
+
+#ifdef PIXGLOT_TARGET_UINT
+out uvec4 fragColor;
+
+// 4294967040 is the largest float below 2^32
+uvec4 target_color(vec4 color) {
+  color = clamp(color, 0.0, 1.0);
+  return mix(uvec4(color * 4294967040.0), uvec4(0xffffffffu),
+             greaterThanEqual(color, vec4(1.0)));
+}
+#else
+out vec4 fragColor;
+
+vec4 target_color(vec4 color) {
+  return color;
+}
+#endif
+
+void main() {
+  vec4 color = source_color();
+
+#if defined(PIXGLOT_GAMMA)
+  color = pixglot_pow(color, exponent);
+#elif defined(PIXGLOT_SRGB_TO_LINEAR)
+  color.rgb = pixglot_srgb_to_linear(color.rgb);
+#elif defined(PIXGLOT_LINEAR_TO_SRGB)
+  color.rgb = pixglot_linear_to_srgb(color.rgb);
+#endif
+
+#if defined(PIXGLOT_PREMULTIPLY)
+  color.rgb *= color.a;
+#elif defined(PIXGLOT_UNPREMULTIPLY)
+  if (color.a > 0.0) {
+    color.rgb /= color.a;
+  }
+#endif
+
+#ifdef PIXGLOT_TARGET_GRAY_ALPHA
+  // two channel targets are stored as red and green
+  color = vec4(color.r, color.a, 0.0, 1.0);
+#endif
+
+  fragColor = target_color(color);
+}
+)";
+
+
+
+constexpr std::string_view palette_fragment_shader = R"(
+#version 450 core
+
+out vec4 fragColor;
+
+layout (binding=0) uniform sampler2D indexSampler;
+layout (binding=1) uniform sampler2D paletteSampler;
+
 void main() {
-  vec4 source_color = texture(textureSampler, uvCoord);
-  fragColor = pow(source_color, exponent);
+  float index = texelFetch(indexSampler, ivec2(gl_FragCoord.xy), 0).r;
+  fragColor = texelFetch(paletteSampler, ivec2(round(index * 255.0), 0), 0);
 }
 )";
+
+
+
+// Linear filtering of the chroma planes at the luma positions matches the triangle
+// filter of the cpu expansion for centered chroma.
+constexpr std::string_view yuv_fragment_shader = R"(
+#version 450 core
+
+out vec4 fragColor;
+
+layout (binding=0) uniform sampler2D ySampler;
+layout (binding=1) uniform sampler2D uSampler;
+layout (binding=2) uniform sampler2D vSampler;
+
+layout (location=1) uniform vec3 offset;
+layout (location=2) uniform mat3 matrix;
+
+void main() {
+  vec2 uv = gl_FragCoord.xy / vec2(textureSize(ySampler, 0));
+
+  vec3 yuv = vec3(
+    texelFetch(ySampler, ivec2(gl_FragCoord.xy), 0).r,
+    texture(uSampler, uv).r,
+    texture(vSampler, uv).r
+  );
+
+  fragColor = vec4(clamp(matrix * (yuv - offset), 0.0, 1.0), 1.0);
+}
+)";
+
+
+
+std::string_view vertex_shader() {
+  return vertex_shader_source;
+}
+
+
+
+std::string fragment_shader(const shader_variant& variant) {
+  if (variant.palette) {
+    return std::string{palette_fragment_shader};
+  }
+
+  if (variant.yuv) {
+    return std::string{yuv_fragment_shader};
+  }
+
+  std::string source{fragment_shader_version};
+
+  const auto define = [&source](bool enabled, std::string_view name) {
+    if (enabled) {
+      source += "#define ";
+      source += name;
+      source += '\n';
+    }
+  };
+
+  define(variant.source_uint,       "PIXGLOT_SOURCE_UINT");
+  define(variant.source_alpha,      "PIXGLOT_SOURCE_ALPHA");
+  define(variant.gamma,             "PIXGLOT_GAMMA");
+  define(variant.srgb_to_linear,    "PIXGLOT_SRGB_TO_LINEAR");
+  define(variant.linear_to_srgb,    "PIXGLOT_LINEAR_TO_SRGB");
+  define(variant.premultiply > 0,   "PIXGLOT_PREMULTIPLY");
+  define(variant.premultiply < 0,   "PIXGLOT_UNPREMULTIPLY");
+  define(variant.target_gray_alpha, "PIXGLOT_TARGET_GRAY_ALPHA");
+  define(variant.target_uint,       "PIXGLOT_TARGET_UINT");
+
+  source += pixglot::details::glsl_transfer_functions;
+  source += fragment_shader_main;
+
+  return source;
+}
 }
 
 
@@ -248,16 +502,23 @@ namespace pixglot::details {
       gl_texture&     texture,
       pixel_format    target_format,
       int             premultiply,
-      float           gamma_diff,
+      gamma_transfer  gamma,
       square_isometry transform
   ) {
+    using curve = gamma_transfer::curve;
+
+    bool power = gamma.function == curve::power && std::abs(gamma.exponent - 1.f) >= 1e-7;
+
     if (transform == square_isometry::identity
-        && std::abs(gamma_diff - 1.f) < 1e-7
+        && gamma.function == curve::power && !power
         && premultiply == 0
         && target_format == texture.format()) {
       return;
     }
 
+    // the shaders work on the stored values, not on linearised samples
+    texture.srgb(false);
+
     size_t width {texture.width()};
     size_t height{texture.height()};
 
@@ -266,28 +527,118 @@ namespace pixglot::details {
     }
 
 
-    gl_texture target{width, height, target_format};
+    size_t levels = gl_texture::mipmap_capable(target_format) ? texture.levels() : 1;
+    gl_texture target{width, height, target_format, levels};
 
-    {
-      framebuffer buffer{target};
-      program     program{vertex_shader, fragment_shader};
-      plane       quad;
+    shader_variant variant {
+      .source_uint       = texture.format().format == data_format::u32,
+      .source_alpha      = has_alpha(texture.format().channels),
+      .gamma             = power,
+      .srgb_to_linear    = gamma.function == curve::srgb_to_linear,
+      .linear_to_srgb    = gamma.function == curve::linear_to_srgb,
+      .premultiply       = has_alpha(texture.format().channels) ? premultiply : 0,
+      .target_gray_alpha = target_format.channels == color_channels::gray_a,
+      .target_uint       = target_format.format == data_format::u32,
+    };
 
-      glViewport(0, 0, utils::int_cast<GLsizei>(width), utils::int_cast<GLsizei>(height));
-      glClearColor(1.f, 0.f, 0.f, 1.f);
-      glClear(GL_COLOR_BUFFER_BIT);
+    auto& cache = gl_cache::current();
+    cache.bind_target(target);
+    cache.use(variant);
 
-      program.use();
+    auto matrix = square_isometry_to_mat4x4(transform);
+    glUniformMatrix4fv(0, 1, GL_TRUE, matrix.data());
 
-      auto matrix = square_isometry_to_mat4x4(transform);
-      glUniformMatrix4fv(0, 1, GL_TRUE, matrix.data());
+    if (variant.gamma) {
+      glUniform4f(1, gamma.exponent, gamma.exponent, gamma.exponent, 1.f);
+    }
 
-      glUniform4f(1, gamma_diff, gamma_diff, gamma_diff, 1.f);
+    texture.bind();
+    cache.draw();
 
-      texture.bind();
-      quad.draw();
+    // only the first level is drawn, the others are derived from it
+    if (target.levels() > 1) {
+      target.generate_mipmaps();
     }
 
     texture = std::move(target);
   }
+
+
+
+  [[nodiscard]] gl_texture expand_palette_to_texture(const indexed_buffer& source) {
+    gl_texture target{source.width(), source.height(), source.format()};
+
+    if (source.empty()) {
+      return target;
+    }
+
+    gl_texture indices{source.indices()};
+
+    pixel_buffer colors{indexed_buffer::max_palette_size, 1, rgba<u8>::format()};
+    std::ranges::copy(source.lookup_table(), colors.row<rgba<u8>>(0).begin());
+    gl_texture palette{colors};
+
+    auto& cache = gl_cache::current();
+    cache.bind_target(target);
+    cache.use(shader_variant{.palette = true});
+
+    auto matrix = square_isometry_to_mat4x4(square_isometry::identity);
+    glUniformMatrix4fv(0, 1, GL_TRUE, matrix.data());
+
+    glActiveTexture(GL_TEXTURE1);
+    palette.bind();
+    glActiveTexture(GL_TEXTURE0);
+    indices.bind();
+
+    cache.draw();
+
+    return target;
+  }
+
+
+
+  [[nodiscard]] gl_texture expand_yuv_to_texture(const yuv_buffer& source) {
+    gl_texture target{source.width(), source.height(), source.format()};
+
+    if (source.empty() || source.width() == 0 || source.height() == 0) {
+      return target;
+    }
+
+    gl_texture luma{source.y()};
+    gl_texture cb  {source.u()};
+    gl_texture cr  {source.v()};
+
+    // the border color would bleed into the interpolated edges
+    for (const auto* plane: {&cb, &cr}) {
+      plane->bind();
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    auto& cache = gl_cache::current();
+    cache.bind_target(target);
+    cache.use(shader_variant{.yuv = true});
+
+    auto transform = square_isometry_to_mat4x4(square_isometry::identity);
+    glUniformMatrix4fv(0, 1, GL_TRUE, transform.data());
+
+    auto coeffs = yuv_to_rgb(source.matrix(), source.full_range());
+    //NOLINTNEXTLINE(*-magic-numbers)
+    glUniform3f(1, coeffs.y_offset / 255.f, 128.f / 255.f, 128.f / 255.f);
+
+    auto matrix = yuv_to_rgb_matrix(coeffs);
+    glUniformMatrix3fv(2, 1, GL_TRUE, matrix.data());
+
+    glActiveTexture(GL_TEXTURE2);
+    cr.bind();
+    glActiveTexture(GL_TEXTURE1);
+    cb.bind();
+    glActiveTexture(GL_TEXTURE0);
+    luma.bind();
+
+    cache.draw();
+
+    return target;
+  }
+
 }
@@ -1,3 +1,5 @@
+#include "pixglot/conversions.hpp"
+#include "pixglot/details/transfer-functions.hpp"
 #include "pixglot/exception.hpp"
 #include "pixglot/square-isometry.hpp"
 #include "pixglot/pixel-buffer.hpp"
@@ -10,7 +12,7 @@ namespace pixglot::details {
       std::optional<std::endian> /*target_endian*/,
       pixel_format               /*target_format*/,
       int                        /*premultiply*/,
-      float                      /*gamma*/,
+      gamma_transfer             /*gamma*/,
       square_isometry            /*transform*/
   ) {
     throw base_exception{"conversion function for cpu disabled"};
@@ -1,23 +1,72 @@
 #include "pixglot/conversions.hpp"
 
+#include "pixglot/details/transfer-functions.hpp"
 #include "pixglot/frame.hpp"
+#include "pixglot/exception.hpp"
 #include "pixglot/gl-texture.hpp"
+#include "pixglot/gl-texture-array.hpp"
+#include "pixglot/image.hpp"
+#include "pixglot/indexed-buffer.hpp"
 #include "pixglot/pixel-buffer.hpp"
 #include "pixglot/pixel-format.hpp"
 #include "pixglot/square-isometry.hpp"
+#include "pixglot/yuv-buffer.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 using namespace pixglot;
 
 
 
 namespace pixglot::details {
-  void convert(gl_texture&, pixel_format, int, float, square_isometry);
+  void convert(gl_texture&, pixel_format, int, gamma_transfer, square_isometry);
 
   void convert(pixel_buffer&, std::optional<std::endian>,
-                      pixel_format, int, float, square_isometry);
+                      pixel_format, int, gamma_transfer, square_isometry);
 
   void apply_orientation(pixel_buffer&, square_isometry);
   void apply_byte_swap(pixel_buffer&);
+
+  [[nodiscard]] pixel_buffer expand_palette(const indexed_buffer&);
+  [[nodiscard]] gl_texture   expand_palette_to_texture(const indexed_buffer&);
+
+  [[nodiscard]] pixel_buffer expand_yuv(const yuv_buffer&);
+  [[nodiscard]] gl_texture   expand_yuv_to_texture(const yuv_buffer&);
+
+
+
+  // moves the layers of image::texture_array back into textures of their frames
+  void unpack_texture_array(image& img) {
+    if (!img.texture_array()) {
+      return;
+    }
+
+    for (auto& f: img.frames()) {
+      if (auto layer = f.layer()) {
+        f.reset(img.texture_array()->layer_texture(*layer));
+      }
+    }
+
+    img.texture_array().reset();
+  }
+
+
+
+  // same tolerance as srgb_texture_for
+  gamma_transfer gamma_transfer::between(float source, float target) {
+    auto is = [](float gamma, float value) { return std::abs(gamma - value) < 1e-3f; };
+
+    gamma_transfer transfer = power(source / target);
+
+    if (is(source, gamma_s_rgb) && is(target, gamma_linear)) {
+      transfer.function = curve::srgb_to_linear;
+    } else if (is(source, gamma_linear) && is(target, gamma_s_rgb)) {
+      transfer.function = curve::linear_to_srgb;
+    }
+
+    return transfer;
+  }
 }
 
 
@@ -27,10 +76,39 @@ namespace pixglot::details {
 namespace {
   template<typename... Args>
   void convert_image(image& img, void (function)(frame&, Args...), Args... value) {
+    details::unpack_texture_array(img);
+
     for (auto& f: img.frames()) {
       function(f, value...);
     }
   }
+
+
+
+  // gamma and alpha mode of indexed buffers only concern the palette
+  void convert_palette(indexed_buffer& indexed, int premultiply,
+                       details::gamma_transfer gamma) {
+    auto palette = indexed.palette();
+    if (palette.empty()) {
+      return;
+    }
+
+    pixel_buffer colors{palette.size(), 1, rgba<u8>::format()};
+    std::ranges::copy(palette, colors.row<rgba<u8>>(0).begin());
+
+    details::convert(colors, {}, colors.format(), premultiply, gamma, {});
+
+    std::ranges::copy(colors.row<rgba<u8>>(0), palette.begin());
+  }
+
+
+
+  // planar yuv frames are converted to rgb before any change of their pixels
+  void expand_yuv(frame& f) {
+    if (f.type() == storage_type::yuv) {
+      convert_storage(f, storage_type::pixel_buffer);
+    }
+  }
 }
 
 
@@ -44,6 +122,10 @@ void pixglot::convert_gamma(image& img, float target) {
 
 
 void pixglot::convert_gamma(frame& f, float target) {
+  if (f.gamma() != target) {
+    expand_yuv(f);
+  }
+
   f.visit_storage([src=f.gamma(), target](auto& arg) {
     convert_gamma(arg, src, target);
   });
@@ -53,14 +135,32 @@ void pixglot::convert_gamma(frame& f, float target) {
 
 
 
+// These have always applied the exponent target / current.
 void pixglot::convert_gamma(pixel_buffer& pb, float current, float target) {
-  details::convert(pb, {}, pb.format(), 0, target / current, {});
+  details::convert(pb, {}, pb.format(), 0,
+                   details::gamma_transfer::between(target, current), {});
 }
 
 
 
 void pixglot::convert_gamma(gl_texture& tex, float current, float target) {
-  details::convert(tex, tex.format(), 0, target / current, {});
+  details::convert(tex, tex.format(), 0,
+                   details::gamma_transfer::between(target, current), {});
+}
+
+
+
+void pixglot::convert_gamma(indexed_buffer& indexed, float current, float target) {
+  convert_palette(indexed, 0, details::gamma_transfer::between(target, current));
+}
+
+
+
+void pixglot::convert_gamma(yuv_buffer& /*yuv*/, float current, float target) {
+  if (current != target) {
+    throw base_exception{"Unable to convert gamma",
+      "yuv buffers must be expanded before changing their gamma"};
+  }
 }
 
 
@@ -89,6 +189,13 @@ void pixglot::convert_pixel_format(
     case storage_type::gl_texture:
       convert_pixel_format(f.texture(), target_format);
       break;
+    case storage_type::indexed:
+    case storage_type::yuv:
+      if (target_format != f.format()) {
+        convert_storage(f, storage_type::pixel_buffer);
+        convert_pixel_format(f.pixels(), target_format, target_endian);
+      }
+      break;
     case storage_type::no_pixels:
       break;
   }
@@ -97,7 +204,7 @@ void pixglot::convert_pixel_format(
 
 
 void pixglot::convert_pixel_format(gl_texture& texture, pixel_format target_format) {
-  details::convert(texture, target_format, 0, 1.f, square_isometry::identity);
+  details::convert(texture, target_format, 0, {}, square_isometry::identity);
 }
 
 
@@ -135,6 +242,11 @@ void pixglot::convert_orientation(image& img, square_isometry target) {
 
 
 void pixglot::convert_orientation(frame& f, square_isometry target) {
+  if (f.orientation() != target) {
+    expand_yuv(f);
+    f.clear_changed_region();
+  }
+
   f.visit_storage([src=f.orientation(), target](auto& arg) {
       convert_orientation(arg, src, target);
   });
@@ -164,7 +276,30 @@ void pixglot::convert_orientation(
   if (source == target) {
     return;
   }
-  details::convert(texture, texture.format(), 0, 1.f, inverse(target) * source);
+  details::convert(texture, texture.format(), 0, {}, inverse(target) * source);
+}
+
+
+
+void pixglot::convert_orientation(
+    indexed_buffer& indexed,
+    square_isometry source,
+    square_isometry target
+) {
+  convert_orientation(indexed.indices(), source, target);
+}
+
+
+
+void pixglot::convert_orientation(
+    yuv_buffer&     /*yuv*/,
+    square_isometry source,
+    square_isometry target
+) {
+  if (source != target) {
+    throw base_exception{"Unable to convert orientation",
+      "yuv buffers must be expanded before changing their orientation"};
+  }
 }
 
 
@@ -182,6 +317,15 @@ void pixglot::convert_storage(frame& frm, storage_type target) {
     return;
   }
 
+  if (frm.layer()) {
+    throw base_exception{"Unable to convert storage",
+      "frames stored in a texture array must be converted as part of their image"};
+  }
+
+  if (target == storage_type::indexed || target == storage_type::yuv) {
+    throw base_exception{"Unable to convert storage",
+      "frames cannot be converted to " + to_string(target) + " storage"};
+  }
 
   if (target == storage_type::no_pixels) {
     frm.reset(frm.width(), frm.height(), frm.format());
@@ -191,6 +335,12 @@ void pixglot::convert_storage(frame& frm, storage_type target) {
       case storage_type::gl_texture:
         frm.reset(frm.texture().download());
         break;
+      case storage_type::indexed:
+        frm.reset(details::expand_palette(frm.indexed()));
+        break;
+      case storage_type::yuv:
+        frm.reset(details::expand_yuv(frm.yuv()));
+        break;
       case storage_type::no_pixels:
         frm.reset(pixel_buffer{frm.width(), frm.height(), frm.format()});
         std::ranges::fill(frm.pixels().data(), std::byte{0});
@@ -205,6 +355,12 @@ void pixglot::convert_storage(frame& frm, storage_type target) {
         convert_endian(frm.pixels(), std::endian::native);
         frm.reset(gl_texture{frm.pixels()});
         break;
+      case storage_type::indexed:
+        frm.reset(details::expand_palette_to_texture(frm.indexed()));
+        break;
+      case storage_type::yuv:
+        frm.reset(details::expand_yuv_to_texture(frm.yuv()));
+        break;
       case storage_type::no_pixels:
         frm.reset(gl_texture{frm.width(), frm.height(), frm.format()});
         break;
@@ -257,7 +413,7 @@ void pixglot::convert_alpha_mode(
   if (source == target) {
     return;
   }
-  details::convert(pixels, {}, pixels.format(), get_premultiply(source, target), 1.f, {});
+  details::convert(pixels, {}, pixels.format(), get_premultiply(source, target), {}, {});
 }
 
 
@@ -270,5 +426,26 @@ void pixglot::convert_alpha_mode(
   if (source == target) {
     return;
   }
-  details::convert(texture, texture.format(), get_premultiply(source, target), 1.f, {});
+  details::convert(texture, texture.format(), get_premultiply(source, target), {}, {});
 }
+
+
+
+void pixglot::convert_alpha_mode(
+    indexed_buffer& indexed,
+    alpha_mode      source,
+    alpha_mode      target
+) {
+  if (source == target) {
+    return;
+  }
+  convert_palette(indexed, get_premultiply(source, target), {});
+}
+
+
+
+void pixglot::convert_alpha_mode(
+    yuv_buffer& /*yuv*/,
+    alpha_mode  /*source*/,
+    alpha_mode  /*target*/
+) {}
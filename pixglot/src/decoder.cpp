@@ -3,8 +3,12 @@
 #include "pixglot/conversions.hpp"
 #include "pixglot/exception.hpp"
 #include "pixglot/frame.hpp"
+#include "pixglot/gl-texture-array.hpp"
 #include "pixglot/pixel-buffer.hpp"
 
+#include "config.hpp"
+
+#include <algorithm>
 #include <utility>
 
 #include <GL/gl.h>
@@ -13,6 +17,14 @@ using namespace pixglot::details;
 
 
 
+namespace pixglot::details {
+  void unpack_texture_array(pixglot::image&);
+
+  [[nodiscard]] bool srgb_texture_for(const pixglot::frame_view&, bool);
+}
+
+
+
 
 
 decoder::decoder(
@@ -22,12 +34,24 @@ decoder::decoder(
 ) :
   reader_{&read},
   token_ {std::move(token)},
-  format_{format}
+  format_{format},
+  requested_format_{format}
 {
   if (format_->storage_type().require(storage_type::gl_texture)) {
     format_replacement_.emplace(*format);
     format_replacement_->endian(std::endian::native);
 
+    // Frames are decoded into pixel buffers which are uploaded directly to their
+    // layer, without creating a texture for each frame. Mipmaps are generated once
+    // for the whole array.
+    if (format_->texture_array().prefers(true)) {
+      pack_layers_ = true;
+#ifdef PIXGLOT_WITH_CPU_CONVERSIONS
+      format_replacement_->storage_type(storage_type::pixel_buffer);
+#endif
+      format_replacement_->mipmaps(false);
+    }
+
     format_ = &(*format_replacement_);
   }
 }
@@ -76,6 +100,98 @@ namespace {
 
 
 
+void decoder::upload_lines(size_t y, size_t h) {
+  static constexpr size_t max_slot_size = 4 * 1024 * 1024;
+
+  //NOLINTNEXTLINE(*-unchecked-optional-access)
+  const auto& texture = current_frame_->texture();
+  const auto& source  = target();
+
+  if (!unpack_ring_supported_) {
+    unpack_ring_supported_ = unpack_ring::supported();
+  }
+
+  size_t row_size = source.width() * source.format().size();
+
+  if (*unpack_ring_supported_ && row_size > 0 &&
+      (!unpack_ring_ || unpack_ring_->slot_size() < row_size)) {
+    unpack_ring_.emplace(std::max(row_size,
+                                  std::min(row_size * texture.height(), max_slot_size)));
+  }
+
+  details::upload_lines(texture, source, y - strip_begin_, y, h,
+      unpack_ring_ ? &(*unpack_ring_) : nullptr);
+}
+
+
+
+size_t decoder::frame_height() const {
+  if (current_frame_) {
+    return current_frame_->height();
+  }
+  return target_ != nullptr ? target_->height() : 0;
+}
+
+
+
+void decoder::flush_strip() {
+  size_t end = std::min(strip_begin_ + target().height(), frame_height());
+  if (end <= uploaded_) {
+    return;
+  }
+
+  auto endian = target().endian();
+  convert_endian(target(), std::endian::native);
+
+  upload_lines(uploaded_, end - uploaded_);
+  uploaded_ = end;
+
+  target().endian(endian);
+}
+
+
+
+std::span<std::byte> decoder::target_row(size_t y) {
+  if (!strip_) {
+    return target().row_bytes(y);
+  }
+
+  if (y < strip_begin_) {
+    throw std::runtime_error{"rows of a strip transfer must be written top to bottom"};
+  }
+
+  if (y >= strip_begin_ + target().height()) {
+    flush_strip();
+    strip_begin_ = y;
+    uploaded_    = std::max(uploaded_, y);
+  }
+
+  return target().row_bytes(y - strip_begin_);
+}
+
+
+
+size_t decoder::target_rows_from(size_t y) const {
+  auto height = frame_height();
+  if (y >= height) {
+    return 0;
+  }
+
+  if (!strip_) {
+    return height - y;
+  }
+
+  auto strip_height = target_->height();
+  if (y < strip_begin_ + strip_height) {
+    return std::min(strip_begin_ + strip_height, height) - y;
+  }
+  return std::min(strip_height, height - y);
+}
+
+
+
+
+
 void decoder::frame_mark_ready_until_line(size_t y) {
   if (current_frame_ &&
       direction_compatible(direction::up, upload_direction_) &&
@@ -83,8 +199,7 @@ void decoder::frame_mark_ready_until_line(size_t y) {
       token_.upload_requested()) {
     upload_direction_ = std::to_underlying(direction::up);
 
-    //NOLINTNEXTLINE(*-unchecked-optional-access)
-    current_frame_->texture().upload_lines(target(), uploaded_, y - uploaded_);
+    upload_lines(uploaded_, y - uploaded_);
     if (token_.flush_uploads()) {
       glFlush();
     }
@@ -92,13 +207,13 @@ void decoder::frame_mark_ready_until_line(size_t y) {
     uploaded_ = y;
   }
 
-  progress(y, target().height(), frame_index_, frame_total_);
+  progress(y, frame_height(), frame_index_, frame_total_);
 }
 
 
 
 void decoder::frame_mark_ready_from_line(size_t y) {
-  auto height = target().height();
+  auto height = frame_height();
 
   if (current_frame_ &&
       direction_compatible(direction::down, upload_direction_) &&
@@ -111,8 +226,7 @@ void decoder::frame_mark_ready_from_line(size_t y) {
     }
 
     if (y < uploaded_) {
-      //NOLINTNEXTLINE(*-unchecked-optional-access)
-      current_frame_->texture().upload_lines(target(), y, uploaded_ - y);
+      upload_lines(y, uploaded_ - y);
       if (token_.flush_uploads()) {
         glFlush();
       }
@@ -169,9 +283,17 @@ void decoder::finish_frame() {
 
   pixel_target_.reset();
   target_ = nullptr;
+  strip_  = false;
+
 
+  if (!plan_ || !plan_->applicable(*current_frame_)) {
+    plan_.emplace(describe(*current_frame_), *format_);
+  }
+  plan_->apply(*current_frame_);
 
-  make_format_compatible(*current_frame_, *format_);
+  if (pack_layers_) {
+    append_layer(*current_frame_);
+  }
 
   if (!token_.append_frame(image_.add_frame(std::move(*current_frame_)))) {
     throw decoding_aborted{};
@@ -196,6 +318,58 @@ bool decoder::wants_pixel_transfer() const {
 
 
 
+bool decoder::wants_indexed() const {
+  return format_->storage_type().prefers(storage_type::indexed);
+}
+
+
+
+bool decoder::wants_yuv() const {
+  return format_->storage_type().prefers(storage_type::yuv);
+}
+
+
+
+
+
+pixglot::frame& decoder::begin_frame(indexed_buffer indexed) {
+  if (current_frame_) {
+    throw std::runtime_error{
+      "begin_frame called but previous frame has not been finished"};
+  }
+
+  if (!wants_indexed()) {
+    throw std::runtime_error{"begin_frame called with indexed buffer but not requested"};
+  }
+
+  current_frame_.emplace(std::move(indexed));
+  pixel_target_.reset();
+
+  target_ = &current_frame_->indexed().indices();
+
+  return *current_frame_;
+}
+
+
+
+pixglot::frame& decoder::begin_frame(yuv_buffer yuv) {
+  if (current_frame_) {
+    throw std::runtime_error{
+      "begin_frame called but previous frame has not been finished"};
+  }
+
+  if (!wants_yuv()) {
+    throw std::runtime_error{"begin_frame called with yuv buffer but not requested"};
+  }
+
+  current_frame_.emplace(std::move(yuv));
+  pixel_target_.reset();
+
+  target_ = &current_frame_->yuv().y();
+
+  return *current_frame_;
+}
+
 
 
 pixglot::frame& decoder::begin_frame(
@@ -218,10 +392,16 @@ pixglot::frame& decoder::begin_frame(
     target_ = nullptr;
 
   } else if (format_->storage_type().require(storage_type::gl_texture)) {
-    current_frame_.emplace(gl_texture{width, height, format});
-    pixel_target_.emplace(width, height, format, endian);
+    // the pixel target is allocated by begin_pixel_transfer or begin_strip_transfer
+    size_t levels = format_->mipmaps().prefers(true) &&
+      gl_texture::mipmap_capable(format) ? gl_texture::max_levels(width, height) : 1;
+    // assumes the default sRGB gamma, the conversion plan corrects other frames
+    bool srgb = format_->srgb_texture().prefers(true) && gl_texture::srgb_capable(format);
+    current_frame_.emplace(gl_texture{width, height, format, levels, srgb});
+    pixel_target_.reset();
+    target_endian_ = endian;
 
-    target_ = &(*pixel_target_);
+    target_ = nullptr;
 
   } else {
     current_frame_.emplace(pixel_buffer{width, height, format, endian});
@@ -246,13 +426,109 @@ void decoder::begin_pixel_transfer() {
     throw decoding_aborted{};
   }
 
-  if (pixel_target_ && current_frame_->type() == storage_type::gl_texture) {
+  bool texture_target = current_frame_->type() == storage_type::gl_texture;
+
+  if (texture_target && !pixel_target_) {
+    const auto& texture = current_frame_->texture();
+    pixel_target_.emplace(texture.width(), texture.height(), texture.format(),
+                          target_endian_);
+    target_ = &(*pixel_target_);
+  }
+
+  if (strip_) {
+    upload_direction_ = std::to_underlying(direction::up);
+  } else if (texture_target) {
     upload_direction_ = std::to_underlying(direction::unset);
   } else {
     upload_direction_ = std::to_underlying(direction::no_upload);
   }
 
-  uploaded_ = 0;
+  uploaded_    = 0;
+  strip_begin_ = 0;
+}
+
+
+
+void decoder::begin_strip_transfer() {
+  static constexpr size_t strip_size     = 8 * 1024 * 1024;
+  static constexpr size_t min_strip_rows = 16;
+  static constexpr size_t max_strip_rows = 256;
+
+  if (current_frame_ && current_frame_->type() == storage_type::gl_texture &&
+      !pixel_target_) {
+    const auto& texture = current_frame_->texture();
+
+    size_t row_size = std::max<size_t>(texture.width() * texture.format().size(), 1);
+    size_t rows     = std::clamp(strip_size / row_size, min_strip_rows, max_strip_rows);
+
+    pixel_target_.emplace(texture.width(), std::min(rows, texture.height()),
+                          texture.format(), target_endian_);
+    target_ = &(*pixel_target_);
+    strip_  = true;
+  }
+
+  begin_pixel_transfer();
+}
+
+
+
+
+
+void decoder::append_layer(frame& f) {
+  auto& array = image_.texture_array();
+  size_t layer = image_.size();
+
+  if (!array) {
+    array.emplace(f.width(), f.height(), std::max<size_t>(frame_total_, 1), f.format());
+  }
+
+  if (array->width() != f.width() || array->height() != f.height() ||
+      array->format() != f.format()) {
+    stop_packing_layers(f);
+    return;
+  }
+
+  if (layer >= array->layers()) {
+    array->resize_layers(std::max(layer + 1, 2 * array->layers()));
+  }
+
+  if (f.type() == storage_type::pixel_buffer) {
+    array->upload_layer(layer, f.pixels());
+  } else {
+    array->copy_layer(layer, f.texture());
+  }
+
+  f.reset(f.width(), f.height(), f.format());
+  f.layer(layer);
+}
+
+
+
+// frames of different size or format get a texture each, like without texture_array
+void decoder::stop_packing_layers(frame& current) {
+  pack_layers_ = false;
+
+  details::unpack_texture_array(image_);
+
+  format_replacement_->storage_type(requested_format_->storage_type());
+  format_replacement_->mipmaps     (requested_format_->mipmaps());
+  plan_.reset();
+
+  convert_storage(current, storage_type::gl_texture);
+
+  auto finish_texture = [this](frame& f) {
+    if (format_->srgb_texture().preferred()) {
+      f.texture().srgb(details::srgb_texture_for(f, *format_->srgb_texture()));
+    }
+    if (format_->mipmaps().prefers(true)) {
+      f.texture().generate_mipmaps();
+    }
+  };
+
+  for (auto& f: image_.frames()) {
+    finish_texture(f);
+  }
+  finish_texture(current);
 }
 
 
@@ -260,6 +536,16 @@ void decoder::begin_pixel_transfer() {
 
 
 pixglot::image decoder::finish() {
+  if (auto& array = image_.texture_array()) {
+    if (array->layers() > image_.size()) {
+      array->resize_layers(image_.size());
+    }
+
+    if (requested_format_->mipmaps().prefers(true)) {
+      array->generate_mipmaps();
+    }
+  }
+
   token_.finish();
   return std::move(image_);
 }
@@ -287,18 +573,22 @@ void decoder::finish_pixel_transfer() {
     return;
   }
 
+  if (strip_) {
+    flush_strip();
+    return;
+  }
+
   convert_endian(*pixel_target_, std::endian::native);
 
   switch (static_cast<direction>(upload_direction_)) {
     case direction::up:
-      current_frame_->texture().upload_lines(target(), uploaded_,
-          target().height() - uploaded_);
+      upload_lines(uploaded_, target().height() - uploaded_);
       break;
     case direction::down:
-      current_frame_->texture().upload_lines(target(), 0, uploaded_);
+      upload_lines(0, uploaded_);
       break;
     default:
-      current_frame_->texture().upload_lines(target(), 0, target().height());
+      upload_lines(0, target().height());
       break;
   }
 }
@@ -17,7 +17,9 @@ namespace {
   using pixel_storage = std::variant<
     pixel_buffer,
     gl_texture,
-    details::no_pixels
+    details::no_pixels,
+    indexed_buffer,
+    yuv_buffer
   >;
 }
 
@@ -36,7 +38,9 @@ class frame_view::impl {
     frame_source_info          source_info;
     pixglot::metadata          metadata;
 
-    std::optional<std::string> name;
+    std::optional<std::string>  name;
+    std::optional<size_t>       layer;
+    std::optional<frame_region> changed_region;
 
 
     impl(pixel_storage store) :
@@ -73,6 +77,14 @@ const pixel_buffer& frame_view::pixels() const {
   return std::get<pixel_buffer>(impl_->storage);
 }
 
+const indexed_buffer& frame_view::indexed() const {
+  return std::get<indexed_buffer>(impl_->storage);
+}
+
+const yuv_buffer& frame_view::yuv() const {
+  return std::get<yuv_buffer>(impl_->storage);
+}
+
 
 
 pixel_format frame_view::format() const {
@@ -100,6 +112,14 @@ std::optional<std::string_view> frame_view::name() const {
   return impl_->name;
 }
 
+std::optional<size_t> frame_view::layer() const {
+  return impl_->layer;
+}
+
+std::optional<frame_region> frame_view::changed_region() const {
+  return impl_->changed_region;
+}
+
 
 
 size_t frame_view::id() const {
@@ -130,6 +150,18 @@ frame::frame(gl_texture texture) :
 
 
 
+frame::frame(indexed_buffer indexed) :
+  frame_view{std::make_shared<impl>(std::move(indexed))}
+{}
+
+
+
+frame::frame(yuv_buffer yuv) :
+  frame_view{std::make_shared<impl>(std::move(yuv))}
+{}
+
+
+
 frame::frame(size_t width, size_t height, pixel_format format) :
   frame_view{std::make_shared<impl>(details::no_pixels{width, height, format})}
 {}
@@ -144,19 +176,46 @@ void frame::alpha_mode (pixglot::alpha_mode alpha   ) { impl_->alpha_mode  = alp
 void frame::name       (std::string         name    ) { impl_->name = std::move(name); }
 void frame::clear_name ()                             { impl_->name.reset();           }
 
+void frame::layer      (size_t              layer   ) { impl_->layer = layer;          }
+void frame::clear_layer()                             { impl_->layer.reset();          }
 
+void frame::changed_region(frame_region region) { impl_->changed_region = region; }
+void frame::clear_changed_region()              { impl_->changed_region.reset();  }
 
-void frame::reset(pixel_buffer pixels ) { impl_->storage = std::move(pixels);  }
-void frame::reset(gl_texture   texture) { impl_->storage = std::move(texture); }
+
+
+// a frame with storage of its own no longer refers to a layer
+void frame::reset(pixel_buffer pixels) {
+  impl_->storage = std::move(pixels);
+  impl_->layer.reset();
+}
+
+void frame::reset(gl_texture texture) {
+  impl_->storage = std::move(texture);
+  impl_->layer.reset();
+}
+
+void frame::reset(indexed_buffer indexed) {
+  impl_->storage = std::move(indexed);
+  impl_->layer.reset();
+}
+
+void frame::reset(yuv_buffer yuv) {
+  impl_->storage = std::move(yuv);
+  impl_->layer.reset();
+}
 
 void frame::reset(size_t width, size_t height, pixel_format format) {
   impl_->storage = details::no_pixels{width, height, format};
+  impl_->layer.reset();
 }
 
 
 
-gl_texture&        frame::texture()     { return std::get<gl_texture  >(impl_->storage); }
-pixel_buffer&      frame::pixels()      { return std::get<pixel_buffer>(impl_->storage); }
+gl_texture&     frame::texture() { return std::get<gl_texture    >(impl_->storage); }
+pixel_buffer&   frame::pixels()  { return std::get<pixel_buffer  >(impl_->storage); }
+indexed_buffer& frame::indexed() { return std::get<indexed_buffer>(impl_->storage); }
+yuv_buffer&     frame::yuv()     { return std::get<yuv_buffer    >(impl_->storage); }
 
 frame_source_info& frame::source_info() { return impl_->source_info; }
 pixglot::metadata& frame::metadata()    { return impl_->metadata;    }
@@ -166,6 +225,15 @@ pixglot::metadata& frame::metadata()    { return impl_->metadata;    }
 
 
 
+std::string pixglot::to_string(const frame_region& region) {
+  return std::to_string(region.width) + 'x' + std::to_string(region.height) +
+    '+' + std::to_string(region.x) + '+' + std::to_string(region.y);
+}
+
+
+
+
+
 std::string_view pixglot::stringify(alpha_mode a) {
   switch (a) {
     case alpha_mode::none:          return "none";
@@ -182,6 +250,8 @@ std::string_view pixglot::stringify(storage_type t) {
     case storage_type::pixel_buffer: return "pixel buffer";
     case storage_type::gl_texture:   return "gl texture";
     case storage_type::no_pixels:    return "no pixels";
+    case storage_type::indexed:      return "indexed";
+    case storage_type::yuv:          return "yuv";
   }
   return "<invalid pixel_target>";
 }
@@ -194,7 +264,8 @@ namespace {
   [[nodiscard]] std::string storage_type_to_string(const frame_view& f) {
     if (f.type() == storage_type::no_pixels) {
       return std::to_string(f.width()) + 'x' + std::to_string(f.height()) +
-        '@' + to_string(f.format());
+        '@' + to_string(f.format()) +
+        (f.layer() ? "(layer=" + std::to_string(*f.layer()) + ")" : "");
     }
 
     return f.visit_storage([](auto&& arg) { return to_string(arg); });
@@ -0,0 +1,139 @@
+#include <epoxy/gl.h>
+#include <epoxy/gl_generated.h>
+
+#include "pixglot/gl-canvas.hpp"
+
+#include "pixglot/exception.hpp"
+#include "pixglot/pixel-buffer.hpp"
+#include "pixglot/utils/gl.hpp"
+#include "pixglot/utils/int_cast.hpp"
+
+#include <algorithm>
+
+using namespace pixglot;
+
+
+
+namespace {
+  [[nodiscard]] pixel_buffer transparent_black(
+      size_t       width,
+      size_t       height,
+      pixel_format format
+  ) {
+    pixel_buffer buffer{width, height, format};
+    std::ranges::fill(buffer.data(), std::byte{0});
+    return buffer;
+  }
+
+
+
+  void upload_region(
+      const gl_texture&   target,
+      const pixel_buffer& source,
+      size_t              source_x,
+      size_t              source_y,
+      const frame_region& region
+  ) {
+    if (byte_size(source.format().format) > 1 && source.endian() != std::endian::native) {
+      throw base_exception{"trying to upload data with wrong byte order"};
+    }
+
+    target.bind();
+
+    utils::gl_upload_rows(source, source_x, source_y, region);
+  }
+
+
+
+  void copy_region(
+      const gl_texture&   target,
+      const gl_texture&   source,
+      size_t              source_x,
+      size_t              source_y,
+      const frame_region& region
+  ) {
+    glCopyImageSubData(
+      source.id(), GL_TEXTURE_2D, 0,
+      utils::int_cast<GLint>(source_x), utils::int_cast<GLint>(source_y), 0,
+      target.id(), GL_TEXTURE_2D, 0,
+      utils::int_cast<GLint>(region.x), utils::int_cast<GLint>(region.y), 0,
+      utils::int_cast<GLsizei>(region.width), utils::int_cast<GLsizei>(region.height), 1
+    );
+  }
+}
+
+
+
+
+
+gl_canvas::gl_canvas(size_t width, size_t height, pixel_format format, bool srgb) :
+  texture_{transparent_black(width, height, format), 1, srgb}
+{}
+
+
+
+void gl_canvas::present(const frame_view& f) const {
+  if (f.width() == width() && f.height() == height()) {
+    present_region(f, frame_region{.x = 0, .y = 0, .width = width(), .height = height()});
+    return;
+  }
+
+  if (auto region = f.changed_region()) {
+    present_region(f, *region);
+    return;
+  }
+
+  throw base_exception{"Unable to present frame",
+    to_string(f) + " does not cover the canvas " + to_string(texture_)};
+}
+
+
+
+void gl_canvas::present_next(const frame_view& f) const {
+  if (auto region = f.changed_region()) {
+    present_region(f, *region);
+  } else {
+    present(f);
+  }
+}
+
+
+
+// Frames covering the canvas are cut to the region, smaller ones must match it.
+void gl_canvas::present_region(const frame_view& f, const frame_region& region) const {
+  if (region.x + region.width > width() || region.y + region.height > height()) {
+    throw base_exception{"Unable to present frame",
+      "region " + to_string(region) + " exceeds the canvas " + to_string(texture_)};
+  }
+
+  size_t source_x = 0;
+  size_t source_y = 0;
+
+  if (f.width() == width() && f.height() == height()) {
+    source_x = region.x;
+    source_y = region.y;
+  } else if (f.width() != region.width || f.height() != region.height) {
+    throw base_exception{"Unable to present frame",
+      to_string(f) + " does not match its region " + to_string(region)};
+  }
+
+  if (f.format() != format()) {
+    throw bad_pixel_format{f.format(), format()};
+  }
+
+  if (region.width == 0 || region.height == 0) {
+    return;
+  }
+
+  switch (f.type()) {
+    case storage_type::pixel_buffer:
+      upload_region(texture_, f.pixels(), source_x, source_y, region);
+      break;
+    case storage_type::gl_texture:
+      copy_region(texture_, f.texture(), source_x, source_y, region);
+      break;
+    default:
+      throw base_exception{"Unable to present frame",
+        "frames stored as " + to_string(f.type()) + " cannot be presented"};
+  }
+}
@@ -0,0 +1,259 @@
+#include <epoxy/gl.h>
+#include <epoxy/gl_generated.h>
+
+#include "pixglot/gl-texture-array.hpp"
+
+#include "pixglot/exception.hpp"
+#include "pixglot/gl-texture.hpp"
+#include "pixglot/pixel-buffer.hpp"
+#include "pixglot/pixel-format.hpp"
+#include "pixglot/utils/gl.hpp"
+#include "pixglot/utils/int_cast.hpp"
+
+#include <algorithm>
+
+
+
+void pixglot::gl_texture_array::texture_id::cleanup() {
+  if (id != 0) {
+    glDeleteTextures(1, &id);
+  }
+}
+
+
+
+
+
+namespace {
+  [[nodiscard]] GLuint create_texture_array(
+      const pixglot::pixel_format& format,
+      size_t                       width,
+      size_t                       height,
+      size_t                       layers,
+      size_t                       levels
+  ) {
+    GLuint id{0};
+
+    glGenTextures(1, &id);
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+
+    if (width > 0 && height > 0 && layers > 0) {
+      glTexStorage3D(
+        GL_TEXTURE_2D_ARRAY,
+        pixglot::utils::int_cast<GLsizei>(levels),
+        pixglot::utils::gl_internal_format(format),
+        pixglot::utils::int_cast<GLsizei>(width),
+        pixglot::utils::int_cast<GLsizei>(height),
+        pixglot::utils::int_cast<GLsizei>(layers)
+      );
+    }
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+
+    pixglot::utils::gl_swizzle_mask(format.channels, GL_TEXTURE_2D_ARRAY);
+
+    return id;
+  }
+
+
+
+  [[nodiscard]] size_t checked_levels(size_t levels, size_t width, size_t height) {
+    auto max = pixglot::gl_texture::max_levels(width, height);
+    if (levels == 0 || levels > max) {
+      throw pixglot::base_exception{"Invalid texture array",
+        std::to_string(width) + "x" + std::to_string(height) + " texture cannot have "
+          + std::to_string(levels) + " levels, at most " + std::to_string(max)};
+    }
+    return levels;
+  }
+
+
+
+  void assert_layer(const pixglot::gl_texture_array& array, size_t layer) {
+    if (layer >= array.layers()) {
+      throw pixglot::index_out_of_range{layer, array.layers()};
+    }
+  }
+
+
+
+  void assert_layer_size(
+      const pixglot::gl_texture_array& array,
+      size_t                           width,
+      size_t                           height
+  ) {
+    if (width != array.width() || height != array.height()) {
+      throw pixglot::base_exception{"Size mismatch",
+        std::to_string(width) + "x" + std::to_string(height)
+          + " does not fit into a layer of " + to_string(array)};
+    }
+  }
+}
+
+
+
+
+
+pixglot::gl_texture_array::gl_texture_array(
+    size_t       width,
+    size_t       height,
+    size_t       layers,
+    pixel_format format,
+    size_t       levels
+) :
+  width_ {width},
+  height_{height},
+  layers_{layers},
+  levels_{checked_levels(levels, width_, height_)},
+  format_{format},
+
+  id_    {create_texture_array(format_, width_, height_, layers_, levels_)}
+{}
+
+
+
+void pixglot::gl_texture_array::bind() const {
+  glBindTexture(GL_TEXTURE_2D_ARRAY, id_.id);
+}
+
+
+
+
+
+void pixglot::gl_texture_array::upload_layer(
+    size_t              layer,
+    const pixel_buffer& source
+) const {
+  assert_layer(*this, layer);
+  assert_layer_size(*this, source.width(), source.height());
+
+  if (source.format() != format_) {
+    throw bad_pixel_format{source.format(), format_};
+  }
+
+  if (width_ == 0 || height_ == 0) {
+    return;
+  }
+
+  if (byte_size(format_.format) > 1 && source.endian() != std::endian::native) {
+    throw base_exception{"trying to upload data with wrong byte order"};
+  }
+
+  bind();
+
+  utils::gl_upload_rows(source, 0, 0, frame_region{0, 0, width_, height_}, layer);
+}
+
+
+
+void pixglot::gl_texture_array::copy_layer(size_t layer, const gl_texture& source) const {
+  assert_layer(*this, layer);
+  assert_layer_size(*this, source.width(), source.height());
+
+  if (source.format() != format_) {
+    throw bad_pixel_format{source.format(), format_};
+  }
+
+  if (width_ == 0 || height_ == 0) {
+    return;
+  }
+
+  glCopyImageSubData(
+    source.id(), GL_TEXTURE_2D,       0, 0, 0, 0,
+    id_.id,      GL_TEXTURE_2D_ARRAY, 0, 0, 0, utils::int_cast<GLint>(layer),
+    utils::int_cast<GLsizei>(width_), utils::int_cast<GLsizei>(height_), 1
+  );
+}
+
+
+
+pixglot::gl_texture pixglot::gl_texture_array::layer_texture(size_t layer) const {
+  assert_layer(*this, layer);
+
+  gl_texture texture{width_, height_, format_};
+
+  if (width_ > 0 && height_ > 0) {
+    glCopyImageSubData(
+      id_.id,       GL_TEXTURE_2D_ARRAY, 0, 0, 0, utils::int_cast<GLint>(layer),
+      texture.id(), GL_TEXTURE_2D,       0, 0, 0, 0,
+      utils::int_cast<GLsizei>(width_), utils::int_cast<GLsizei>(height_), 1
+    );
+  }
+
+  return texture;
+}
+
+
+
+
+
+void pixglot::gl_texture_array::copy_first_level(
+    const texture_id& target,
+    size_t            layers
+) const {
+  if (width_ == 0 || height_ == 0 || layers == 0) {
+    return;
+  }
+
+  glCopyImageSubData(
+    id_.id,    GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+    target.id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+    utils::int_cast<GLsizei>(width_), utils::int_cast<GLsizei>(height_),
+    utils::int_cast<GLsizei>(layers)
+  );
+}
+
+
+
+void pixglot::gl_texture_array::resize_layers(size_t layers) {
+  if (layers == layers_) {
+    return;
+  }
+
+  texture_id resized{create_texture_array(format_, width_, height_, layers, levels_)};
+  copy_first_level(resized, std::min(layers, layers_));
+
+  id_     = std::move(resized);
+  layers_ = layers;
+}
+
+
+
+void pixglot::gl_texture_array::generate_mipmaps() {
+  if (width_ == 0 || height_ == 0 || layers_ == 0 ||
+      !gl_texture::mipmap_capable(format_)) {
+    return;
+  }
+
+  if (levels_ == 1 && gl_texture::max_levels(width_, height_) > 1) {
+    auto levels = gl_texture::max_levels(width_, height_);
+
+    texture_id full{create_texture_array(format_, width_, height_, layers_, levels)};
+    copy_first_level(full, layers_);
+
+    id_     = std::move(full);
+    levels_ = levels;
+  }
+
+  bind();
+
+  if (levels_ > 1) {
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  }
+}
+
+
+
+
+
+std::string pixglot::to_string(const gl_texture_array& array) {
+  return std::to_string(array.width()) + "x" + std::to_string(array.height())
+    + "x" + std::to_string(array.layers()) + "@" + to_string(array.format())
+    + "(gl=" + std::to_string(array.id()) + ")";
+}
@@ -1,5 +1,9 @@
+#include <epoxy/gl.h>
+#include <epoxy/gl_generated.h>
+
 #include "pixglot/gl-texture.hpp"
 
+#include "pixglot/details/unpack-ring.hpp"
 #include "pixglot/exception.hpp"
 #include "pixglot/pixel-buffer.hpp"
 #include "pixglot/pixel-format.hpp"
@@ -7,9 +11,12 @@
 #include "pixglot/utils/gl.hpp"
 #include "pixglot/utils/int_cast.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <optional>
+#include <span>
 #include <stdexcept>
-
-#include <GL/gl.h>
+#include <vector>
 
 
 
@@ -24,13 +31,29 @@ void pixglot::gl_texture::texture_id::cleanup() {
 
 
 namespace {
-  [[nodiscard]] GLuint create_texture(const pixglot::pixel_format& format) {
+  [[nodiscard]] GLuint create_texture(
+      const pixglot::pixel_format& format,
+      size_t                       width,
+      size_t                       height,
+      size_t                       levels,
+      bool                         srgb
+  ) {
     GLuint id{0};
 
     glGenTextures(1, &id);
 
     glBindTexture(GL_TEXTURE_2D, id);
 
+    if (width > 0 && height > 0) {
+      glTexStorage2D(
+        GL_TEXTURE_2D,
+        pixglot::utils::int_cast<GLsizei>(levels),
+        pixglot::utils::gl_internal_format(format, srgb),
+        pixglot::utils::int_cast<GLsizei>(width),
+        pixglot::utils::int_cast<GLsizei>(height)
+      );
+    }
+
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
@@ -44,56 +67,108 @@ namespace {
 
 
 
-  void teximage(const pixglot::gl_texture& tex, const void* data) {
-    glTexImage2D(
-      GL_TEXTURE_2D,
-      0,
-      pixglot::utils::gl_internal_format(tex.format()),
-      pixglot::utils::int_cast<GLsizei>(tex.width()),
-      pixglot::utils::int_cast<GLsizei>(tex.height()),
-      0,
-      pixglot::utils::gl_format(tex.format()),
-      pixglot::utils::gl_type(tex.format()),
-      data
-    );
+  [[nodiscard]] size_t checked_levels(size_t levels, size_t width, size_t height) {
+    auto max = pixglot::gl_texture::max_levels(width, height);
+    if (levels == 0 || levels > max) {
+      throw pixglot::base_exception{"Invalid texture",
+        std::to_string(width) + "x" + std::to_string(height) + " texture cannot have "
+          + std::to_string(levels) + " levels, at most " + std::to_string(max)};
+    }
+    return levels;
   }
+
+
+
+  [[nodiscard]] bool checked_srgb(bool srgb, pixglot::pixel_format format) {
+    if (srgb && !pixglot::gl_texture::srgb_capable(format)) {
+      throw pixglot::base_exception{"Invalid texture",
+        "sRGB textures must be rgb or rgba u8, not " + pixglot::to_string(format)};
+    }
+    return srgb;
+  }
+}
+
+
+
+size_t pixglot::gl_texture::max_levels(size_t width, size_t height) {
+  return std::max<size_t>(std::bit_width(std::max(width, height)), 1);
 }
 
 
 
-pixglot::gl_texture::gl_texture(const pixel_buffer& buffer) :
+pixglot::gl_texture::gl_texture(const pixel_buffer& buffer, size_t levels, bool srgb) :
   width_ {buffer.width()},
   height_{buffer.height()},
+  levels_{checked_levels(levels, width_, height_)},
   format_{buffer.format()},
+  srgb_  {checked_srgb(srgb, format_)},
 
-  id_    {create_texture(format_)}
+  id_    {create_texture(format_, width_, height_, levels_, srgb_)}
 {
   if (width_ > 0 && height_ > 0 && byte_size(format_.format) > 1 &&
       buffer.endian() != std::endian::native) {
     throw base_exception{"trying to upload data with wrong byte order"};
   }
 
-  glPixelStorei(GL_UNPACK_ALIGNMENT,  utils::gl_unpack_alignment(buffer.stride()));
-  glPixelStorei(GL_UNPACK_ROW_LENGTH, utils::gl_pixels_per_stride(buffer));
-
-  teximage(*this, buffer.data().data());
+  if (width_ > 0 && height_ > 0) {
+    utils::gl_upload_rows(buffer, 0, 0, frame_region{0, 0, width_, height_});
+  }
 }
 
 
 
 
 
-pixglot::gl_texture::gl_texture(size_t width, size_t height, pixel_format format) :
+pixglot::gl_texture::gl_texture(
+    size_t       width,
+    size_t       height,
+    pixel_format format,
+    size_t       levels,
+    bool         srgb
+) :
   width_ {width},
   height_{height},
+  levels_{checked_levels(levels, width_, height_)},
   format_{format},
+  srgb_  {checked_srgb(srgb, format_)},
 
-  id_    {create_texture(format_)}
-{
-  teximage(*this, nullptr);
-}
+  id_    {create_texture(format_, width_, height_, levels_, srgb_)}
+{}
+
+
+
+
+
+namespace {
+  void assert_uploadable(
+      const pixglot::gl_texture&   tex,
+      const pixglot::pixel_buffer& source,
+      size_t                       source_y,
+      size_t                       y,
+      size_t                       h
+  ) {
+    if (source.format() != tex.format()) {
+      throw pixglot::bad_pixel_format{source.format(), tex.format()};
+    }
 
+    if (source.width() != tex.width()) {
+      throw pixglot::base_exception{"width mismatch during texture upload"};
+    }
+
+    if (y + h > tex.height()) {
+      throw pixglot::index_out_of_range{y + h, tex.height()};
+    }
+
+    if (source_y + h > source.height()) {
+      throw pixglot::index_out_of_range{source_y + h, source.height()};
+    }
 
+    if (h > 0 && tex.width() > 0 && byte_size(tex.format().format) > 1 &&
+        source.endian() != std::endian::native) {
+      throw pixglot::base_exception{"trying to upload data with wrong byte order"};
+    }
+  }
+}
 
 
 
@@ -102,37 +177,63 @@ void pixglot::gl_texture::upload_lines(
     size_t              y,
     size_t              h
 ) const {
-  if (source.format() != format()) {
-    throw bad_pixel_format{source.format(), format()};
-  }
+  details::upload_lines(*this, source, y, y, h);
+}
+
 
-  if (source.width() != width()) {
-    throw base_exception{"width mismatch during texture upload"};
-  }
 
-  if (y + h > height()) {
-    throw index_out_of_range{y + h, height()};
+// Rows are packed tightly into the slots, which also takes care of bottom_up buffers.
+// The copy stays on purpose: strips are byte swapped in place before uploading and
+// are filled across several partial uploads, longer than any slot stays acquired.
+void pixglot::details::upload_lines(
+    const gl_texture&   tex,
+    const pixel_buffer& source,
+    size_t              source_y,
+    size_t              y,
+    size_t              h,
+    unpack_ring*        ring
+) {
+  assert_uploadable(tex, source, source_y, y, h);
+
+  size_t row_size      = tex.width() * tex.format().size();
+  size_t rows_per_slot = 0;
+  if (ring != nullptr && row_size > 0) {
+    rows_per_slot = ring->slot_size() / row_size;
   }
 
-  if (h > 0 && width() > 0 && byte_size(format().format) > 1 &&
-      source.endian() != std::endian::native) {
-    throw base_exception{"trying to upload data with wrong byte order"};
+  tex.bind();
+
+  if (rows_per_slot == 0) {
+    utils::gl_upload_rows(source, 0, source_y, frame_region{0, y, tex.width(), h});
+    return;
   }
 
-  bind();
+  glPixelStorei(GL_UNPACK_ALIGNMENT,  utils::gl_unpack_alignment(row_size));
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+  for (size_t i = 0; i < h; i += rows_per_slot) {
+    size_t rows = std::min(rows_per_slot, h - i);
+    auto   slot = ring->acquire();
 
-  glPixelStorei(GL_UNPACK_ALIGNMENT,  utils::gl_unpack_alignment(source.stride()));
-  glPixelStorei(GL_UNPACK_ROW_LENGTH, utils::gl_pixels_per_stride(source));
-
-  glTexSubImage2D(
-    GL_TEXTURE_2D,
-    0,
-    0, utils::int_cast<GLint>(y),
-    utils::int_cast<GLsizei>(width()), utils::int_cast<GLsizei>(h),
-    pixglot::utils::gl_format(format()),
-    pixglot::utils::gl_type(format()),
-    source.data().subspan(y * source.stride(), h * source.stride()).data()
-  );
+    for (size_t r = 0; r < rows; ++r) {
+      std::ranges::copy(source.row_bytes(source_y + i + r),
+                        slot.memory.subspan(r * row_size).begin());
+    }
+
+    glTexSubImage2D(
+      GL_TEXTURE_2D,
+      0,
+      0, utils::int_cast<GLint>(y + i),
+      utils::int_cast<GLsizei>(tex.width()),
+      utils::int_cast<GLsizei>(rows),
+      utils::gl_format(tex.format()),
+      utils::gl_type(tex.format()),
+      //NOLINTNEXTLINE(*-reinterpret-cast,performance-no-int-to-ptr)
+      reinterpret_cast<const void*>(slot.offset)
+    );
+
+    ring->release();
+  }
 }
 
 
@@ -158,126 +259,302 @@ void pixglot::gl_texture::update() {
 
   glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &buffer);
   format_ = utils::pixel_format_from_gl_internal(buffer);
+  srgb_   = utils::is_gl_srgb_internal(buffer);
+
+  // mutable textures report zero levels
+  glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_LEVELS, &buffer);
+  levels_ = std::max(buffer, 1);
 }
 
 
 
 
 
-namespace {
-  template<size_t ChunkSize>
-  void repack_row_sized(
-      pixglot::pixel_format format,
-      std::span<const std::byte>  source,
-      std::span<std::byte>        target
-  ) {
-    using chunk = std::array<std::byte, ChunkSize>;
-    auto src = pixglot::utils::interpret_as<const chunk>(source);
-    auto tgt = pixglot::utils::interpret_as<      chunk>(target);
+void pixglot::gl_texture::generate_mipmaps() {
+  if (width_ == 0 || height_ == 0 || !mipmap_capable(format_)) {
+    return;
+  }
 
-    auto src_it = src.begin();
-    auto tgt_it = tgt.begin();
+  if (levels_ == 1 && max_levels(width_, height_) > 1) {
+    texture_id full{create_texture(format_, width_, height_,
+                                   max_levels(width_, height_), srgb_)};
 
-    auto tgt_end = tgt.end();
+    glCopyImageSubData(
+      id_.id,  GL_TEXTURE_2D, 0, 0, 0, 0,
+      full.id, GL_TEXTURE_2D, 0, 0, 0, 0,
+      utils::int_cast<GLsizei>(width_), utils::int_cast<GLsizei>(height_), 1
+    );
 
-    switch (format.channels) {
-      case pixglot::color_channels::gray:
-        while (tgt_it != tgt_end) {
-          *tgt_it++ = *src_it;
-          src_it += 4;
-        }
-        break;
+    id_     = std::move(full);
+    levels_ = max_levels(width_, height_);
+  }
 
-      case pixglot::color_channels::gray_a:
-        while (tgt_it != tgt_end) {
-          *tgt_it++ = *src_it;
-          src_it += 3;
-          *tgt_it++ = *src_it++;
-        }
-        break;
-
-      case pixglot::color_channels::rgb:
-        while (tgt_it != tgt_end) {
-          *tgt_it++ = *src_it++;
-          *tgt_it++ = *src_it++;
-          *tgt_it++ = *src_it;
-          src_it += 2;
-        }
-        break;
+  bind();
 
-      case pixglot::color_channels::rgba:
-        break;
-    }
+  if (levels_ > 1) {
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
   }
+}
 
 
 
-  void repack_row(
-      pixglot::pixel_format format,
-      std::span<const std::byte>  source,
-      std::span<std::byte>        target
-  ) {
-    if (pixglot::n_channels(format.channels) == 4) {
-      std::ranges::copy(source, target.begin());
-      return;
-    }
+// GL_SRGB8(_ALPHA8) and GL_RGB(A)8 are in the same view class, so the levels can be
+// copied as they are.
+void pixglot::gl_texture::srgb(bool srgb) {
+  if (srgb == srgb_) {
+    return;
+  }
 
-    switch (byte_size(format.format)) {
-      case 1: repack_row_sized<1>(format, source, target); break;
-      case 2: repack_row_sized<2>(format, source, target); break;
-      case 4: repack_row_sized<4>(format, source, target); break;
+  texture_id target{create_texture(format_, width_, height_, levels_,
+                                   checked_srgb(srgb, format_))};
 
-      default: break;
-    }
+  for (size_t level = 0; level < levels_ && width_ > 0 && height_ > 0; ++level) {
+    glCopyImageSubData(
+      id_.id,    GL_TEXTURE_2D, utils::int_cast<GLint>(level), 0, 0, 0,
+      target.id, GL_TEXTURE_2D, utils::int_cast<GLint>(level), 0, 0, 0,
+      utils::int_cast<GLsizei>(std::max<size_t>(width_  >> level, 1)),
+      utils::int_cast<GLsizei>(std::max<size_t>(height_ >> level, 1)),
+      1
+    );
   }
+
+  bind();
+  GLint min_filter{GL_LINEAR};
+  glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &min_filter);
+
+  id_   = std::move(target);
+  srgb_ = srgb;
+
+  bind();
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
 }
 
 
 
-pixglot::pixel_buffer pixglot::gl_texture::download() {
-  update();
 
-  pixel_buffer pixels{width(), height(), format()};
 
+namespace {
+  // Configures the pack state to write rows at the stride of buffer if GL can express
+  // it, otherwise rows are packed tightly.
+  [[nodiscard]] bool pack_at_stride(const pixglot::pixel_buffer& buffer) {
+    auto alignment = pixglot::utils::gl_unpack_alignment(buffer.stride());
+    auto length    = pixglot::utils::gl_pixels_per_stride(buffer);
+
+    size_t row = pixglot::utils::int_cast<size_t>(length) * buffer.format().size();
+    if (auto diff = row % alignment; diff != 0) {
+      row += alignment - diff;
+    }
 
+    if (row == buffer.stride() && !buffer.bottom_up()) {
+      glPixelStorei(GL_PACK_ALIGNMENT,  alignment);
+      glPixelStorei(GL_PACK_ROW_LENGTH, length);
+      return true;
+    }
 
-  size_t stride_bytes = width() * 4 * byte_size(format().format);
-  GLint alignment{0};
-  glGetIntegerv(GL_PACK_ALIGNMENT, &alignment);
-  if (alignment < 1) {
-    throw std::runtime_error{"opengl texture has non-positive alignment"};
+    glPixelStorei(GL_PACK_ALIGNMENT,  1);
+    glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    return false;
   }
 
-  if (stride_bytes % alignment != 0) {
-    stride_bytes += alignment - (stride_bytes % alignment);
+
+
+  void copy_packed_rows(std::span<const std::byte> source, pixglot::pixel_buffer& target) {
+    size_t row_size = target.width() * target.format().size();
+
+    for (size_t y = 0; y < target.height(); ++y) {
+      std::ranges::copy(source.subspan(y * row_size, row_size),
+                        target.row_bytes(y).begin());
+    }
   }
+}
 
 
 
-  if (n_channels(format().channels) == 4 && stride_bytes == pixels.stride()) {
+pixglot::pixel_buffer pixglot::gl_texture::download() {
+  update();
+
+  pixel_buffer pixels{width(), height(), format()};
+
+  if (width() == 0 || height() == 0) {
+    return pixels;
+  }
+
+  if (pack_at_stride(pixels)) {
     glGetTexImage(GL_TEXTURE_2D, 0, utils::gl_format(format()), utils::gl_type(format()),
         pixels.data().data());
     return pixels;
   }
 
-
-
-  std::vector<std::byte> buffer(height() * stride_bytes);
+  std::vector<std::byte> buffer(width() * height() * format().size());
   glGetTexImage(GL_TEXTURE_2D, 0, utils::gl_format(format()), utils::gl_type(format()),
       buffer.data());
 
+  copy_packed_rows(buffer, pixels);
 
+  return pixels;
+}
 
-  for (size_t y = 0; y < height(); ++y) {
-    repack_row(
-        format(),
-        std::span{buffer}
-          .subspan(y * stride_bytes, width() * 4 * byte_size(format().format)),
-        pixels.row_bytes(y)
-    );
+
+
+
+
+namespace pixglot::details {
+  void wait_for_sync(GLsync);
+}
+
+
+
+class pixglot::texture_readback::impl {
+  public:
+    explicit impl(const gl_texture& texture) :
+      pixels_{pixel_buffer{texture.width(), texture.height(), texture.format()}},
+      size_  {texture.width() * texture.height() * texture.format().size()}
+    {
+      if (size_ == 0) {
+        return;
+      }
+
+      at_stride_ = pack_at_stride(*pixels_);
+      if (at_stride_) {
+        size_ = pixels_->data().size();
+      }
+
+      glGenBuffers(1, &buffer_);
+      if (buffer_ == 0) {
+        throw base_exception{"unable to create pixel pack buffer"};
+      }
+
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer_);
+      glBufferData(GL_PIXEL_PACK_BUFFER, utils::int_cast<GLsizeiptr>(size_), nullptr,
+          GL_STREAM_READ);
+
+      texture.bind();
+      glGetTexImage(GL_TEXTURE_2D, 0, utils::gl_format(texture.format()),
+          utils::gl_type(texture.format()), nullptr);
+
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+      fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glFlush();
+    }
+
+
+
+    impl(const impl&) = delete;
+    impl(impl&&)      = delete;
+    impl& operator=(const impl&) = delete;
+    impl& operator=(impl&&)      = delete;
+
+    ~impl() {
+      if (fence_ != nullptr) {
+        glDeleteSync(fence_);
+      }
+
+      if (buffer_ != 0) {
+        glDeleteBuffers(1, &buffer_);
+      }
+    }
+
+
+
+    [[nodiscard]] bool ready() const {
+      if (fence_ == nullptr) {
+        return true;
+      }
+
+      GLint status{GL_UNSIGNALED};
+      glGetSynciv(fence_, GL_SYNC_STATUS, 1, nullptr, &status);
+      return status == GL_SIGNALED;
+    }
+
+
+
+    [[nodiscard]] pixel_buffer get() {
+      if (!pixels_) {
+        throw base_exception{"texture readback has already been retrieved"};
+      }
+
+      if (fence_ != nullptr) {
+        details::wait_for_sync(fence_);
+        glDeleteSync(fence_);
+        fence_ = nullptr;
+      }
+
+      if (size_ > 0) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer_);
+
+        const auto* mapped =
+          glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, utils::int_cast<GLsizeiptr>(size_),
+              GL_MAP_READ_BIT);
+
+        if (mapped == nullptr) {
+          glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+          throw base_exception{"unable to map pixel pack buffer"};
+        }
+
+        std::span source{static_cast<const std::byte*>(mapped), size_};
+        if (at_stride_) {
+          std::ranges::copy(source, pixels_->data().begin());
+        } else {
+          copy_packed_rows(source, *pixels_);
+        }
+
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      }
+
+      auto pixels = std::move(*pixels_);
+      pixels_.reset();
+      return pixels;
+    }
+
+
+
+  private:
+    std::optional<pixel_buffer> pixels_;
+    size_t                      size_;
+    bool                        at_stride_{false};
+
+    GLuint                      buffer_{0};
+    GLsync                      fence_{nullptr};
+};
+
+
+
+pixglot::texture_readback::texture_readback(std::unique_ptr<impl> impl) :
+  impl_{std::move(impl)}
+{}
+
+pixglot::texture_readback::texture_readback(texture_readback&&) noexcept = default;
+
+pixglot::texture_readback&
+pixglot::texture_readback::operator=(texture_readback&&) noexcept = default;
+
+pixglot::texture_readback::~texture_readback() = default;
+
+
+
+bool pixglot::texture_readback::ready() const {
+  if (!impl_) {
+    throw base_exception{"texture readback has been moved from"};
   }
+  return impl_->ready();
+}
 
-  return pixels;
+pixglot::pixel_buffer pixglot::texture_readback::get() {
+  if (!impl_) {
+    throw base_exception{"texture readback has been moved from"};
+  }
+  return impl_->get();
+}
+
+
+
+pixglot::texture_readback pixglot::gl_texture::download_async() {
+  update();
+
+  return texture_readback{std::make_unique<texture_readback::impl>(*this)};
 }
 
 
@@ -294,5 +571,6 @@ void pixglot::gl_texture::bind() const {
 
 std::string pixglot::to_string(const gl_texture& texture) {
   return std::to_string(texture.width()) + "x" + std::to_string(texture.height())
-    + "@" + to_string(texture.format()) + "(gl=" + std::to_string(texture.id()) + ")";
+    + "@" + to_string(texture.format()) + "(gl=" + std::to_string(texture.id())
+    + (texture.srgb() ? ", srgb)" : ")");
 }
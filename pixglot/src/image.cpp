@@ -4,6 +4,7 @@
 #include "pixglot/metadata.hpp"
 
 #include <chrono>
+#include <optional>
 #include <vector>
 
 using namespace pixglot;
@@ -19,6 +20,8 @@ class image::impl {
 
     pixglot::metadata           metadata;
 
+    std::optional<gl_texture_array> texture_array;
+
     pixglot::codec              codec{codec::ppm};
     std::string                 mime_type;
 
@@ -84,6 +87,14 @@ bool image::has_warnings() const {
 const pixglot::metadata& image::metadata() const { return impl_->metadata; }
       pixglot::metadata& image::metadata()       { return impl_->metadata; }
 
+const std::optional<gl_texture_array>& image::texture_array() const {
+  return impl_->texture_array;
+}
+
+std::optional<gl_texture_array>& image::texture_array() {
+  return impl_->texture_array;
+}
+
 
 
 std::string_view image::mime_type() const { return impl_->mime_type; }
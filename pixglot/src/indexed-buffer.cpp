@@ -0,0 +1,50 @@
+#include "pixglot/indexed-buffer.hpp"
+
+#include "pixglot/exception.hpp"
+
+#include <algorithm>
+
+using namespace pixglot;
+
+
+
+indexed_buffer::indexed_buffer(
+    size_t                    width,
+    size_t                    height,
+    std::span<const rgba<u8>> palette,
+    color_channels            channels
+) :
+  indices_ {width, height, gray<u8>::format()},
+  channels_{channels}
+{
+  if (channels_ != color_channels::rgb && channels_ != color_channels::rgba) {
+    throw base_exception{"Invalid indexed buffer",
+      "palette colors must be rgb or rgba, not " + to_string(channels_)};
+  }
+
+  this->palette(palette);
+}
+
+
+
+void indexed_buffer::palette(std::span<const rgba<u8>> palette) {
+  if (palette.size() > max_palette_size) {
+    throw base_exception{"Invalid indexed buffer",
+      "palette has " + std::to_string(palette.size()) + " entries, at most "
+        + std::to_string(max_palette_size) + " are supported"};
+  }
+
+  palette_.fill(rgba<u8>{.r = 0, .g = 0, .b = 0, .a = 0});
+  std::ranges::copy(palette, palette_.begin());
+  palette_size_ = palette.size();
+}
+
+
+
+
+
+std::string pixglot::to_string(const indexed_buffer& buffer) {
+  return std::to_string(buffer.width()) + "x" + std::to_string(buffer.height())
+    + "@" + to_string(buffer.format()) + "[" + std::to_string(buffer.palette().size())
+    + " colors]";
+}
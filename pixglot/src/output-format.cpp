@@ -1,22 +1,31 @@
 #include "pixglot/output-format.hpp"
 
-#include "pixglot/conversions.hpp"
+#include "pixglot/conversion-plan.hpp"
 #include "pixglot/frame.hpp"
-#include "pixglot/gl-texture.hpp"
 #include "pixglot/image.hpp"
 #include "pixglot/pixel-format.hpp"
 #include "pixglot/preference.hpp"
 #include "pixglot/square-isometry.hpp"
 
-#include "config.hpp"
-
 #include <algorithm>
-#include <optional>
+#include <cmath>
 
 using namespace pixglot;
 
 
 
+namespace pixglot::details {
+  // only u8 rgb(a) frames with sRGB gamma have an sRGB internal format
+  [[nodiscard]] bool srgb_texture_for(const frame_view& f, bool srgb_texture) {
+    return srgb_texture && gl_texture::srgb_capable(f.format()) &&
+      std::abs(f.gamma() - gamma_s_rgb) < 1e-3f;
+  }
+}
+
+
+
+
+
 class output_format::impl {
   public:
     preference<pixglot::storage_type> storage_type;
@@ -31,6 +40,10 @@ class output_format::impl {
 
     preference<square_isometry>       orientation;
 
+    preference<bool>                  mipmaps;
+    preference<bool>                  texture_array;
+    preference<bool>                  srgb_texture;
+
 
 
     void make_standard() {
@@ -42,6 +55,9 @@ class output_format::impl {
       gamma              = gamma_s_rgb;
       endian             = std::endian::native;
       orientation        = square_isometry{};
+      mipmaps            = false;
+      texture_array      = false;
+      srgb_texture       = false;
     }
 
 
@@ -55,6 +71,9 @@ class output_format::impl {
       gamma.enforce();
       endian.enforce();
       orientation.enforce();
+      mipmaps.enforce();
+      texture_array.enforce();
+      srgb_texture.enforce();
     }
 
 
@@ -62,7 +81,8 @@ class output_format::impl {
     [[nodiscard]] bool satisfied_by(const image& img) const {
       return std::ranges::all_of(img.frames(), [this](const auto& f) {
           return satisfied_by(f);
-      });
+      }) &&
+      (img.texture_array().has_value() == *texture_array || !texture_array.required());
     }
 
 
@@ -71,12 +91,17 @@ class output_format::impl {
       return satisfied_by(f.format()) &&
         gamma.satisfied_by(f.gamma()) &&
         orientation.satisfied_by(f.orientation()) &&
-        storage_type.satisfied_by(f.type()) &&
+        storage_type.satisfied_by(f.layer() ? storage_type::gl_texture : f.type()) &&
         (f.type() != storage_type::pixel_buffer ||
          byte_size(f.format().format) == 1 ||
          endian.satisfied_by(f.pixels().endian())) &&
         (f.alpha_mode() == alpha_mode::none ||
-         alpha_mode.satisfied_by(f.alpha_mode()));
+         alpha_mode.satisfied_by(f.alpha_mode())) &&
+        (f.type() != storage_type::gl_texture || !*mipmaps || !mipmaps.required() ||
+         !gl_texture::mipmap_capable(f.format()) ||
+         f.texture().levels() == gl_texture::max_levels(f.width(), f.height())) &&
+        (f.type() != storage_type::gl_texture || !srgb_texture.required() ||
+         f.texture().srgb() == details::srgb_texture_for(f, *srgb_texture));
     }
 
 
@@ -179,6 +204,18 @@ void output_format::orientation(preference<square_isometry> pref) {
   impl_->orientation = pref;
 }
 
+void output_format::mipmaps(preference<bool> pref) {
+  impl_->mipmaps = pref;
+}
+
+void output_format::texture_array(preference<bool> pref) {
+  impl_->texture_array = pref;
+}
+
+void output_format::srgb_texture(preference<bool> pref) {
+  impl_->srgb_texture = pref;
+}
+
 
 
 
@@ -263,6 +300,36 @@ preference<square_isometry>& output_format::orientation() {
 
 
 
+const preference<bool>& output_format::mipmaps() const {
+  return impl_->mipmaps;
+}
+
+preference<bool>& output_format::mipmaps() {
+  return impl_->mipmaps;
+}
+
+
+
+const preference<bool>& output_format::texture_array() const {
+  return impl_->texture_array;
+}
+
+preference<bool>& output_format::texture_array() {
+  return impl_->texture_array;
+}
+
+
+
+const preference<bool>& output_format::srgb_texture() const {
+  return impl_->srgb_texture;
+}
+
+preference<bool>& output_format::srgb_texture() {
+  return impl_->srgb_texture;
+}
+
+
+
 
 
 
@@ -310,132 +377,12 @@ bool output_format::preference_satisfied_by(color_channels cc) const {
 
 
 
-namespace pixglot::details {
-  void convert(gl_texture&, pixel_format, int, float, square_isometry);
-
-  void convert(pixel_buffer&, std::optional<std::endian>,
-                      pixel_format, int, float, square_isometry);
-}
-
-
-
-
-namespace {
-  void apply_conversions(
-      frame&               f,
-      const output_format& fmt,
-      pixel_format         target_format,
-      int                  premultiply,
-      float                gamma,
-      square_isometry      transform
-  ) {
-    if (fmt.storage_type().required() ||
-        fmt.storage_type().prefers(storage_type::no_pixels)) {
-      convert_storage(f, *fmt.storage_type());
-    }
-
-    if (f.format() == target_format &&
-        premultiply == 0 &&
-        gamma == 1.f &&
-        transform == square_isometry::identity) {
-      return;
-    }
-
-#ifndef PIXGLOT_WITH_CPU_CONVERSIONS
-    if (fmt.storage_type().prefers(storage_type::gl_texture)) {
-      convert_storage(f, *fmt.storage_type());
-    }
-#endif
-
-    if (f.type() == storage_type::gl_texture) {
-      details::convert(f.texture(), target_format, premultiply, gamma, transform);
-
-    } else if (f.type() == storage_type::pixel_buffer) {
-      auto target_endian = fmt.endian().required() ?
-        std::optional{*fmt.endian()} : std::nullopt;
-
-      details::convert(f.pixels(), target_endian,
-          target_format, premultiply, gamma, transform);
-
-      if (byte_size(f.format().format) == 1 &&
-          fmt.endian().preferred()) {
-        f.pixels().endian(*fmt.endian());
-      }
-    }
-  }
-
-
-
-  void make_compatible(frame& f, const output_format& fmt) {
-    square_isometry transform{};
-    if (fmt.orientation().required()) {
-      transform = inverse(*fmt.orientation()) * f.orientation();
-      f.orientation(*fmt.orientation());
-    }
-
-
-    int premultiply{};
-    if (fmt.alpha_mode().required()) {
-      if (f.alpha_mode() == alpha_mode::straight &&
-          *fmt.alpha_mode() == alpha_mode::premultiplied) {
-        premultiply = 1;
-        f.alpha_mode(alpha_mode::premultiplied);
-      } else if (f.alpha_mode() == alpha_mode::premultiplied
-                 && *fmt.alpha_mode() == alpha_mode::straight) {
-        premultiply = -1;
-        f.alpha_mode(alpha_mode::straight);
-      }
-    }
-
-
-    float gamma{1.f};
-    if (fmt.gamma().required()) {
-      gamma = f.gamma() / *fmt.gamma();
-      f.gamma(*fmt.gamma());
-    }
-
-
-    auto target_format = f.format();
-    if (fmt.fill_alpha().required()) {
-      target_format.channels = add_alpha(target_format.channels);
-
-      if (f.alpha_mode() == alpha_mode::none) {
-        if (fmt.alpha_mode().preferred()) {
-          f.alpha_mode(*fmt.alpha_mode());
-        } else {
-          f.alpha_mode(alpha_mode::straight);
-        }
-      }
-    }
-    if (fmt.expand_gray_to_rgb().required()) {
-      target_format.channels = add_color(target_format.channels);
-    }
-    if (fmt.data_format().required()) {
-      target_format.format = *fmt.data_format();
-    }
-
-
-    apply_conversions(f, fmt, target_format, premultiply, gamma, transform);
-  }
-}
-
-
-
-
-
 void pixglot::make_format_compatible(
     frame&               f,
     const output_format& fmt,
     bool                 enforce
 ) {
-  if (enforce) {
-    auto enforced = fmt;
-    enforced.enforce();
-    make_compatible(f, fmt);
-    return;
-  }
-
-  make_compatible(f, fmt);
+  conversion_plan{describe(f), fmt, enforce}.apply(f);
 }
 
 
@@ -445,16 +392,9 @@ void pixglot::make_format_compatible(
     const output_format& fmt,
     bool                 enforce
 ) {
-  if (enforce) {
-    auto enforced = fmt;
-    enforced.enforce();
-    for (auto& f: img.frames()) {
-      make_compatible(f, fmt);
-    }
+  if (img.frames().empty()) {
     return;
   }
 
-  for (auto& f : img.frames()) {
-    make_compatible(f, fmt);
-  }
+  conversion_plan{describe(img.frames().front()), fmt, enforce}.apply(img);
 }
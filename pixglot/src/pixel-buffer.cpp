@@ -1,5 +1,80 @@
 #include "pixglot/pixel-buffer.hpp"
 
+#include <algorithm>
+
+using namespace pixglot;
+
+
+
+pixel_buffer::pixel_buffer(const pixel_buffer& rhs) :
+  pixel_buffer{rhs.width_, rhs.height_, rhs.format_, rhs.endian_}
+{
+  bottom_up_ = rhs.bottom_up_;
+
+  auto source = rhs.data();
+  auto target = data();
+
+  if (stride_ == rhs.stride_) {
+    std::ranges::copy(source, target.begin());
+    return;
+  }
+
+  // sub buffers are compacted to the stride of their own width
+  size_t row_size = width_ * format_.size();
+  for (size_t y = 0; y < height_; ++y) {
+    std::ranges::copy(source.subspan(y * rhs.stride_, row_size),
+                      target.subspan(y * stride_).begin());
+  }
+}
+
+
+
+pixel_buffer& pixel_buffer::operator=(const pixel_buffer& rhs) {
+  if (&rhs != this) {
+    *this = pixel_buffer{rhs};
+  }
+  return *this;
+}
+
+
+
+
+
+pixel_buffer pixel_buffer::sub_buffer(size_t x, size_t y, size_t width, size_t height) {
+  if (x + width > width_) {
+    throw index_out_of_range{x + width, width_ + 1};
+  }
+  if (y + height > height_) {
+    throw index_out_of_range{y + height, height_ + 1};
+  }
+
+  pixel_buffer sub{0, 0, format_, endian_};
+
+  if (width == 0 || height == 0) {
+    sub.width_  = width;
+    sub.height_ = height;
+    return sub;
+  }
+
+  sub.width_     = width;
+  sub.height_    = height;
+  sub.stride_    = stride_;
+  sub.bottom_up_ = bottom_up_;
+  sub.buffer_    = buffer_;
+  sub.offset_    = offset_ + row_offset(bottom_up_ ? y + height - 1 : y)
+                     + x * format_.size();
+
+  return sub;
+}
+
+
+
+void pixel_buffer::unshare() {
+  if (shares_storage()) {
+    *this = pixel_buffer{*this};
+  }
+}
+
 
 
 
@@ -0,0 +1,165 @@
+#include <epoxy/gl.h>
+#include <epoxy/gl_generated.h>
+
+#include "pixglot/details/unpack-ring.hpp"
+#include "pixglot/exception.hpp"
+#include "pixglot/utils/int_cast.hpp"
+
+#include <vector>
+
+using namespace pixglot::details;
+
+
+
+namespace {
+  constexpr GLbitfield map_flags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+}
+
+
+
+namespace pixglot::details {
+  void wait_for_sync(GLsync fence) {
+    constexpr GLuint64 timeout = 1'000'000'000;
+
+    while (true) {
+      switch (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout)) {
+        case GL_ALREADY_SIGNALED:
+        case GL_CONDITION_SATISFIED:
+          return;
+        case GL_WAIT_FAILED:
+          throw base_exception{"unable to wait for gl fence"};
+        default:
+          break;
+      }
+    }
+  }
+}
+
+
+
+
+
+class unpack_ring::impl {
+  public:
+    impl(size_t slot_size, size_t slot_count) :
+      slot_size_{slot_size},
+      fences_   (slot_count, nullptr)
+    {
+      if (slot_size_ == 0 || slot_count == 0) {
+        throw base_exception{"unpack_ring requires a non-empty buffer"};
+      }
+
+      auto size = utils::int_cast<GLsizeiptr>(slot_size_ * slot_count);
+
+      glGenBuffers(1, &buffer_);
+      if (buffer_ == 0) {
+        throw base_exception{"unable to create pixel unpack buffer"};
+      }
+
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, map_flags);
+
+      auto* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, map_flags);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      if (mapped == nullptr) {
+        glDeleteBuffers(1, &buffer_);
+        throw base_exception{"unable to map pixel unpack buffer"};
+      }
+
+      memory_ = std::span{static_cast<std::byte*>(mapped), slot_size_ * slot_count};
+    }
+
+
+
+    impl(const impl&) = delete;
+    impl(impl&&)      = delete;
+    impl& operator=(const impl&) = delete;
+    impl& operator=(impl&&)      = delete;
+
+    ~impl() {
+      for (auto* fence: fences_) {
+        if (fence != nullptr) {
+          glDeleteSync(fence);
+        }
+      }
+
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      glDeleteBuffers(1, &buffer_);
+    }
+
+
+
+    [[nodiscard]] size_t slot_size() const { return slot_size_; }
+
+
+
+    [[nodiscard]] slot acquire() {
+      if (auto*& fence = fences_[current_]; fence != nullptr) {
+        wait_for_sync(fence);
+        glDeleteSync(fence);
+        fence = nullptr;
+      }
+
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer_);
+
+      size_t offset = current_ * slot_size_;
+      return slot {
+        .memory = memory_.subspan(offset, slot_size_),
+        .offset = offset
+      };
+    }
+
+
+
+    void release() {
+      fences_[current_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      current_ = (current_ + 1) % fences_.size();
+    }
+
+
+
+  private:
+    size_t               slot_size_;
+    std::vector<GLsync>  fences_;
+    size_t               current_{0};
+
+    GLuint               buffer_{0};
+    std::span<std::byte> memory_;
+};
+
+
+
+
+
+bool unpack_ring::supported() {
+  return epoxy_gl_version() >= 44 || epoxy_has_gl_extension("GL_ARB_buffer_storage");
+}
+
+
+
+unpack_ring::unpack_ring(size_t slot_size, size_t slot_count) :
+  impl_{std::make_unique<impl>(slot_size, slot_count)}
+{}
+
+unpack_ring::~unpack_ring() = default;
+
+
+
+size_t unpack_ring::slot_size() const {
+  return impl_->slot_size();
+}
+
+unpack_ring::slot unpack_ring::acquire() {
+  return impl_->acquire();
+}
+
+void unpack_ring::release() {
+  impl_->release();
+}
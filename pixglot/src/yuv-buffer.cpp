@@ -0,0 +1,72 @@
+#include "pixglot/yuv-buffer.hpp"
+
+using namespace pixglot;
+
+
+
+std::string_view pixglot::stringify(yuv_matrix matrix) {
+  switch (matrix) {
+    case yuv_matrix::bt601:  return "bt601";
+    case yuv_matrix::bt709:  return "bt709";
+    case yuv_matrix::bt2020: return "bt2020";
+  }
+  return "<invalid yuv_matrix>";
+}
+
+
+
+std::string pixglot::to_string(yuv_matrix matrix) {
+  return std::string{stringify(matrix)};
+}
+
+
+
+
+
+size_t yuv_buffer::chroma_width(size_t width, chroma_subsampling subsampling) {
+  if (subsampling == chroma_subsampling::cs444) {
+    return width;
+  }
+  return (width + 1) / 2;
+}
+
+
+
+size_t yuv_buffer::chroma_height(size_t height, chroma_subsampling subsampling) {
+  if (subsampling == chroma_subsampling::cs420) {
+    return (height + 1) / 2;
+  }
+  return height;
+}
+
+
+
+
+
+yuv_buffer::yuv_buffer(
+    size_t             width,
+    size_t             height,
+    chroma_subsampling subsampling,
+    yuv_matrix         matrix,
+    bool               full_range
+) :
+  y_{width, height, gray<u8>::format()},
+  u_{chroma_width(width, subsampling), chroma_height(height, subsampling),
+     gray<u8>::format()},
+  v_{chroma_width(width, subsampling), chroma_height(height, subsampling),
+     gray<u8>::format()},
+
+  subsampling_{subsampling},
+  matrix_     {matrix},
+  full_range_ {full_range}
+{}
+
+
+
+
+
+std::string pixglot::to_string(const yuv_buffer& buffer) {
+  return std::to_string(buffer.width()) + "x" + std::to_string(buffer.height())
+    + "@yuv" + to_string(buffer.subsampling()) + "(" + to_string(buffer.matrix())
+    + (buffer.full_range() ? "" : ", limited") + ")";
+}
@@ -0,0 +1,1237 @@
+#include "common.hpp"
+
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include <pixglot/conversion-plan.hpp>
+#include <pixglot/conversions.hpp>
+#include <pixglot/exception.hpp>
+#include <pixglot/details/fused-conversion.hpp>
+#include <pixglot/details/transfer-functions.hpp>
+#include <pixglot/details/yuv-coefficients.hpp>
+#include <pixglot/frame.hpp>
+#include <pixglot/indexed-buffer.hpp>
+#include <pixglot/output-format.hpp>
+#include <pixglot/pixel-buffer.hpp>
+#include <pixglot/pixel-format-conversion.hpp>
+#include <pixglot/utils/gl.hpp>
+#include <pixglot/yuv-buffer.hpp>
+
+using namespace pixglot;
+
+
+
+template<pixel_type P>
+[[nodiscard]] pixel_buffer create_buffer(size_t width, size_t height, auto&& generator) {
+  pixel_buffer buffer{width, height, P::format()};
+
+  for (size_t y = 0; y < height; ++y) {
+    auto row = buffer.row<P>(y);
+    for (size_t x = 0; x < width; ++x) {
+      row[x] = generator(x, y);
+    }
+  }
+
+  return buffer;
+}
+
+
+
+[[nodiscard]] f16 half_from_bits(u16 bits) {
+  return std::bit_cast<f16>(bits);
+}
+
+
+
+[[nodiscard]] bool same_value(f32 lhs, f32 rhs) {
+  return (std::isnan(lhs) && std::isnan(rhs)) || lhs == rhs;
+}
+
+
+
+
+
+void test_half_float_to_float() {
+  // every finite and non-finite half float value, in rows of odd width
+  static constexpr size_t width = 251;
+  auto buffer = create_buffer<gray<f16>>(width, 65536 / width + 1, [](size_t x, size_t y) {
+    return gray<f16>{.v = half_from_bits(static_cast<u16>(y * width + x))};
+  });
+
+  auto source = buffer;
+  convert_pixel_format(buffer, gray<f32>::format());
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<gray<f16>>(y);
+    auto tgt = buffer.row<gray<f32>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      id_assert(same_value(tgt[x].v, static_cast<f32>(src[x].v)), "f16 -> f32 mismatch");
+    }
+  }
+
+
+
+  convert_pixel_format(buffer, gray<f16>::format());
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<gray<f16>>(y);
+    auto tgt = buffer.row<gray<f16>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      id_assert(same_value(static_cast<f32>(tgt[x].v), static_cast<f32>(src[x].v)),
+          "f16 -> f32 -> f16 is not lossless");
+    }
+  }
+}
+
+
+
+void test_half_float_rounding() {
+  auto buffer = create_buffer<rgb<f32>>(37, 11, [](size_t x, size_t y) {
+    auto v = static_cast<f32>(x * 7919 + y * 104729) * 1e-3f - 17.f;
+    return rgb<f32>{.r = v, .g = v / 3.f, .b = -v * 1.0001f};
+  });
+
+  auto source = buffer;
+  convert_pixel_format(buffer, rgb<f16>::format());
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<rgb<f32>>(y);
+    auto tgt = buffer.row<rgb<f16>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      id_assert(tgt[x].r == static_cast<f16>(src[x].r), "f32 -> f16 rounding");
+      id_assert(tgt[x].g == static_cast<f16>(src[x].g), "f32 -> f16 rounding");
+      id_assert(tgt[x].b == static_cast<f16>(src[x].b), "f32 -> f16 rounding");
+    }
+  }
+}
+
+
+
+void test_half_float_integer() {
+  auto buffer = create_buffer<gray_a<f16>>(1031, 3, [](size_t x, size_t y) {
+    return gray_a<f16>{
+      .v = static_cast<f16>(static_cast<f32>(x) / 1000.f - 0.01f),
+      .a = static_cast<f16>(static_cast<f32>(y) / 2.f)
+    };
+  });
+
+  auto source = buffer;
+
+  auto as_u8 = buffer;
+  convert_pixel_format(as_u8, gray_a<u8>::format());
+
+  auto as_u16 = buffer;
+  convert_pixel_format(as_u16, rgba<u16>::format());
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<gray_a<f16>>(y);
+    auto u8s = as_u8.row<gray_a<u8>>(y);
+    auto u16s = as_u16.row<rgba<u16>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      id_assert_eq(u8s[x].v, data_format_cast<u8>(src[x].v));
+      id_assert_eq(u8s[x].a, data_format_cast<u8>(src[x].a));
+      id_assert_eq(u16s[x].g, data_format_cast<u16>(src[x].v));
+      id_assert_eq(u16s[x].a, data_format_cast<u16>(src[x].a));
+    }
+  }
+
+
+
+  convert_pixel_format(as_u16, rgba<f16>::format());
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<gray_a<f16>>(y);
+    auto tgt = as_u16.row<rgba<f16>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      auto expected = data_format_cast<f16>(data_format_cast<u16>(src[x].v));
+      id_assert(tgt[x].b == expected, "u16 -> f16 mismatch");
+    }
+  }
+}
+
+
+
+
+
+void test_foreign_endian() {
+  auto buffer = create_buffer<rgb<u16>>(67, 5, [](size_t x, size_t y) {
+    auto v = static_cast<u16>(x * 977 + y * 31);
+    return rgb<u16>{.r = v, .g = static_cast<u16>(~v), .b = static_cast<u16>(v ^ 0x00ff)};
+  });
+
+  auto source  = buffer;
+  auto foreign = buffer;
+
+  for (size_t y = 0; y < foreign.height(); ++y) {
+    for (auto& pix: foreign.row<rgb<u16>>(y)) {
+      pix = rgb<u16>{
+        .r = std::byteswap(pix.r),
+        .g = std::byteswap(pix.g),
+        .b = std::byteswap(pix.b)
+      };
+    }
+  }
+  foreign.endian(std::endian::native == std::endian::little ?
+                   std::endian::big : std::endian::little);
+
+  auto as_u8 = foreign;
+  convert_pixel_format(as_u8, rgb<u8>::format(), std::endian::native);
+
+  auto as_f32 = foreign;
+  convert_pixel_format(as_f32, rgb<f32>::format(), std::endian::native);
+
+  auto as_foreign_u32 = buffer;
+  convert_pixel_format(as_foreign_u32, rgb<u32>::format(), foreign.endian());
+  id_assert(as_foreign_u32.endian() == foreign.endian(), "target endian not respected");
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<rgb<u16>>(y);
+    auto u8s = as_u8.row<rgb<u8>>(y);
+    auto f32s = as_f32.row<rgb<f32>>(y);
+    auto u32s = as_foreign_u32.row<rgb<u32>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      id_assert_eq(u8s[x].r, data_format_cast<u8>(src[x].r));
+      id_assert_eq(u8s[x].b, data_format_cast<u8>(src[x].b));
+      id_assert(f32s[x].g == data_format_cast<f32>(src[x].g), "u16 -> f32 mismatch");
+      id_assert_eq(std::byteswap(u32s[x].r), data_format_cast<u32>(src[x].r));
+    }
+  }
+}
+
+
+
+
+
+template<data_format_type T>
+[[nodiscard]] T expected_gamma(T value, const details::gamma_transfer& gamma) {
+  auto x = data_format_cast<f32>(value);
+
+  if (gamma.function == details::gamma_transfer::curve::power) {
+    return data_format_cast<T>(std::pow(x, gamma.exponent));
+  }
+  return data_format_cast<T>(gamma.apply(details::broadcast(x))[0]);
+}
+
+static constexpr details::gamma_transfer exact_srgb_to_linear{
+  .function = details::gamma_transfer::curve::srgb_to_linear,
+  .exponent = gamma_s_rgb
+};
+
+static constexpr details::gamma_transfer exact_linear_to_srgb{
+  .function = details::gamma_transfer::curve::linear_to_srgb,
+  .exponent = 1.f / gamma_s_rgb
+};
+
+
+
+void test_gamma_u8(float exp, const details::gamma_transfer& expected) {
+  auto buffer = create_buffer<rgba<u8>>(256, 3, [](size_t x, size_t y) {
+    auto v = static_cast<u8>(x);
+    return rgba<u8>{.r = v, .g = static_cast<u8>(255 - v), .b = v, .a = static_cast<u8>(y * 100)};
+  });
+
+  auto source = buffer;
+  convert_gamma(buffer, 1.f, exp);
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<rgba<u8>>(y);
+    auto tgt = buffer.row<rgba<u8>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      id_assert_eq(tgt[x].r, expected_gamma(src[x].r, expected));
+      id_assert_eq(tgt[x].g, expected_gamma(src[x].g, expected));
+      id_assert_eq(tgt[x].a, src[x].a);
+    }
+  }
+}
+
+
+
+void test_gamma_u16_foreign_endian() {
+  auto buffer = create_buffer<gray_a<u16>>(1024, 256, [](size_t x, size_t y) {
+    return gray_a<u16>{.v = static_cast<u16>(y * 1024 + x), .a = static_cast<u16>(x)};
+  });
+  convert_endian(buffer, std::endian::native == std::endian::little ?
+                           std::endian::big : std::endian::little);
+
+  auto source = buffer;
+  convert_gamma(buffer, 2.2f, 1.f);
+
+  id_assert(buffer.endian() == source.endian(), "gamma correction changed endian");
+
+  convert_endian(source);
+  convert_endian(buffer);
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<gray_a<u16>>(y);
+    auto tgt = buffer.row<gray_a<u16>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      id_assert_eq(tgt[x].v, expected_gamma(src[x].v, exact_linear_to_srgb));
+      id_assert_eq(tgt[x].a, src[x].a);
+    }
+  }
+}
+
+
+
+
+
+void test_fast_pow() {
+  using details::f32x4;
+
+  for (f32 exp: {2.2f, 1.f / 2.2f, 2.4f, 1.f / 2.4f, 0.5f, 3.f}) {
+    for (f32 base = 1e-6f; base < 1e3f; base *= 1.0137f) {
+      f32x4 x = details::broadcast(base);
+      x[1] = std::nextafter(base, 0.f);
+      x[2] = base * 0.75f;
+
+      auto result = details::fast_pow(x, exp);
+
+      for (int i = 0; i < 4; ++i) {
+        auto expected = std::pow(static_cast<double>(x[i]), static_cast<double>(exp));
+        auto bound    = 1e-6 * (1. + std::abs(exp * std::log2(static_cast<double>(x[i]))));
+
+        id_assert(std::abs(result[i] - expected) <= bound * expected,
+            "fast_pow exceeds its error bound");
+      }
+    }
+  }
+
+  f32x4 special{0.f, -1.f, INFINITY, NAN};
+  auto result = details::fast_pow(special, 2.2f);
+  id_assert(result[0] == 0.f, "fast_pow(0) != 0");
+  id_assert(std::isnan(result[1]), "fast_pow of negative base is not NaN");
+  id_assert(std::isinf(result[2]), "fast_pow(inf) != inf");
+  id_assert(std::isnan(result[3]), "fast_pow(NaN) != NaN");
+  id_assert(details::fast_pow(details::broadcast(1.f), 2.2f)[0] == 1.f, "fast_pow(1) != 1");
+
+  auto subnormal = details::fast_pow(details::broadcast(1e-45f), 1.f / 2.2f)[0];
+  auto expected  = std::pow(static_cast<double>(1e-45f), static_cast<double>(1.f / 2.2f));
+  id_assert(std::abs(subnormal - expected) <= 1e-6 * expected, "fast_pow of subnormal");
+}
+
+
+
+void test_fast_exp2_overflow() {
+  details::f32x4 y{127.f, 127.5f, std::nextafter(128.f, 0.f), 128.f};
+  auto result = details::fast_exp2(y);
+
+  for (int i = 0; i < 3; ++i) {
+    auto expected = std::exp2(static_cast<double>(y[i]));
+    id_assert(std::isfinite(result[i]) && std::abs(result[i] - expected) <= 1e-6 * expected,
+        "fast_exp2 below 128 is not finite and accurate");
+  }
+
+  id_assert(std::isinf(result[3]), "fast_exp2(128) != inf");
+}
+
+
+
+void test_srgb_transfer() {
+  auto reference_to_linear = [](double x) {
+    return x <= 0.04045 ? x / 12.92 : std::pow((x + 0.055) / 1.055, 2.4);
+  };
+
+  auto reference_to_srgb = [](double x) {
+    return x <= 0.0031308 ? x * 12.92 : 1.055 * std::pow(x, 1. / 2.4) - 0.055;
+  };
+
+  for (size_t i = 0; i <= 4096; i += 4) {
+    details::f32x4 x{};
+    for (size_t j = 0; j < 4; ++j) {
+      x[j] = static_cast<f32>(i + j) / 4096.f;
+    }
+
+    auto linear = details::srgb_to_linear(x);
+    auto srgb   = details::linear_to_srgb(x);
+
+    for (size_t j = 0; j < 4; ++j) {
+      id_assert(std::abs(linear[j] - reference_to_linear(x[j])) < 2e-6, "srgb_to_linear");
+      id_assert(std::abs(srgb[j]   - reference_to_srgb(x[j]))   < 2e-6, "linear_to_srgb");
+    }
+  }
+
+  using curve = details::gamma_transfer::curve;
+  id_assert(details::gamma_transfer::between(gamma_s_rgb, gamma_linear).function
+      == curve::srgb_to_linear, "sRGB to linear is not the sRGB curve");
+  id_assert(details::gamma_transfer::between(gamma_linear, gamma_s_rgb).function
+      == curve::linear_to_srgb, "linear to sRGB is not the sRGB curve");
+  id_assert(details::gamma_transfer::between(4.4f, 2.f).function == curve::power,
+      "power law of 2.2 treated as sRGB");
+  id_assert(details::gamma_transfer::between(gamma_s_rgb, gamma_s_rgb).identity(),
+      "sRGB to sRGB is no identity");
+}
+
+
+
+void test_gamma_f32() {
+  auto buffer = create_buffer<gray_a<f32>>(13, 7, [](size_t x, size_t y) {
+    return gray_a<f32>{.v = static_cast<f32>(x * y) / 91.f, .a = static_cast<f32>(x) / 13.f};
+  });
+
+  auto source = buffer;
+  convert_gamma(buffer, 2.2f, 1.f);
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<gray_a<f32>>(y);
+    auto tgt = buffer.row<gray_a<f32>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      auto expected = expected_gamma(src[x].v, exact_linear_to_srgb);
+      id_assert(std::abs(tgt[x].v - expected) < 1e-6f, "f32 gamma");
+      id_assert_eq(tgt[x].a, src[x].a);
+    }
+  }
+}
+
+
+
+
+
+[[nodiscard]] u32 rounded_div(uint64_t num, uint64_t den) {
+  return static_cast<u32>((2 * num + den) / (2 * den));
+}
+
+
+
+template<data_format_type D>
+void test_alpha_integer() {
+  static constexpr u32 max = std::numeric_limits<D>::max();
+  static constexpr u32 step = max / 255;
+
+  pixel_buffer buffer = create_buffer<rgba<D>>(256, 256, [](size_t x, size_t y) {
+    auto c = static_cast<D>(x * step);
+    auto a = static_cast<D>(y * step);
+    return rgba<D>{.r = c, .g = static_cast<D>(max - c), .b = a, .a = a};
+  });
+
+  pixel_buffer gray_buffer = create_buffer<gray_a<D>>(256, 256, [](size_t x, size_t y) {
+    return gray_a<D>{.v = static_cast<D>(x * step), .a = static_cast<D>(y * step)};
+  });
+
+  pixel_buffer source = buffer;
+  convert_alpha_mode(buffer, alpha_mode::straight, alpha_mode::premultiplied);
+  convert_alpha_mode(gray_buffer,alpha_mode::straight, alpha_mode::premultiplied);
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = source.row<rgba<D>>(y);
+    auto tgt = buffer.row<rgba<D>>(y);
+    auto gry = gray_buffer.row<gray_a<D>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      id_assert_eq(u32{tgt[x].r}, rounded_div(u32{src[x].r} * src[x].a, max));
+      id_assert_eq(u32{tgt[x].g}, rounded_div(u32{src[x].g} * src[x].a, max));
+      id_assert_eq(u32{gry[x].v}, rounded_div(u32{src[x].r} * src[x].a, max));
+      id_assert_eq(tgt[x].a, src[x].a);
+      id_assert_eq(gry[x].a, src[x].a);
+    }
+  }
+
+
+
+  convert_alpha_mode(source, alpha_mode::premultiplied, alpha_mode::straight);
+
+  for (size_t y = 0; y < buffer.height(); ++y) {
+    auto src = buffer.row<rgba<D>>(y);
+    auto tgt = source.row<rgba<D>>(y);
+
+    for (size_t x = 0; x < buffer.width(); ++x) {
+      auto c = static_cast<u32>(x * step);
+      auto a = static_cast<u32>(y * step);
+
+      if (a == 0) {
+        id_assert_eq(u32{tgt[x].r}, c);
+      } else {
+        id_assert_eq(u32{tgt[x].r}, std::min(max, rounded_div(uint64_t{c} * max, a)));
+      }
+      id_assert_eq(tgt[x].a, src[x].a);
+    }
+  }
+}
+
+
+
+void test_alpha_gray_f32() {
+  auto buffer = create_buffer<gray_a<f32>>(5, 1, [](size_t x, size_t /*y*/) {
+    return gray_a<f32>{.v = 0.5f, .a = static_cast<f32>(x) / 4.f};
+  });
+
+  convert_alpha_mode(buffer, alpha_mode::straight, alpha_mode::premultiplied);
+
+  for (size_t x = 0; x < buffer.width(); ++x) {
+    id_assert_eq(buffer.row<gray_a<f32>>(0)[x].v, 0.5f * static_cast<f32>(x) / 4.f);
+  }
+
+  convert_alpha_mode(buffer, alpha_mode::premultiplied, alpha_mode::straight);
+
+  for (size_t x = 1; x < buffer.width(); ++x) {
+    id_assert_eq(buffer.row<gray_a<f32>>(0)[x].v, 0.5f);
+  }
+}
+
+
+
+
+
+template<pixel_type P>
+[[nodiscard]] P pixel_id(size_t x, size_t y) {
+  P pix{};
+  auto components = std::as_writable_bytes(std::span{&pix, 1});
+  for (size_t i = 0; i < components.size(); ++i) {
+    components[i] = static_cast<std::byte>((x * 31 + y * 17 + i * 7 + x / 256 + y / 256) & 0xff);
+  }
+  return pix;
+}
+
+
+
+template<pixel_type P>
+void test_orientation(size_t width, size_t height) {
+  pixel_buffer source = create_buffer<P>(width, height, pixel_id<P>);
+
+  auto expected = [&](square_isometry iso, size_t tx, size_t ty) {
+    switch (iso) {
+      case square_isometry::transpose:      return pixel_id<P>(ty, tx);
+      case square_isometry::rotate_cw:      return pixel_id<P>(ty, height - 1 - tx);
+      case square_isometry::rotate_ccw:     return pixel_id<P>(width - 1 - ty, tx);
+      case square_isometry::anti_transpose: return pixel_id<P>(width - 1 - ty, height - 1 - tx);
+      default: throw iso;
+    }
+  };
+
+  for (auto iso: {square_isometry::transpose, square_isometry::rotate_cw,
+                  square_isometry::rotate_ccw, square_isometry::anti_transpose}) {
+    pixel_buffer buffer = source;
+    convert_orientation(buffer, iso);
+
+    id_assert_eq(buffer.width(),  height);
+    id_assert_eq(buffer.height(), width);
+
+    for (size_t y = 0; y < buffer.height(); ++y) {
+      auto row = buffer.row<P>(y);
+      for (size_t x = 0; x < buffer.width(); ++x) {
+        auto exp = expected(iso, x, y);
+        id_assert(std::ranges::equal(std::as_bytes(std::span{&row[x], 1}),
+                                     std::as_bytes(std::span{&exp, 1})),
+            "orientation of " + to_string(P::format()) + " mismatch");
+      }
+    }
+  }
+}
+
+
+
+template<pixel_type P>
+void test_orientation() {
+  test_orientation<P>(1, 1);
+  test_orientation<P>(3, 17);
+  test_orientation<P>(37, 21);
+  test_orientation<P>(301, 170);
+}
+
+
+
+
+
+[[nodiscard]] bool same_pixels(const pixel_buffer& lhs, const pixel_buffer& rhs) {
+  if (lhs.width() != rhs.width() || lhs.height() != rhs.height()
+      || lhs.format() != rhs.format() || lhs.endian() != rhs.endian()) {
+    return false;
+  }
+
+  for (size_t y = 0; y < lhs.height(); ++y) {
+    if (!std::ranges::equal(lhs.row_bytes(y), rhs.row_bytes(y))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+
+void test_fused_conversion(
+    const pixel_buffer& source,
+    pixel_format        target_format,
+    std::endian         target_endian,
+    float               gamma
+) {
+  for (auto iso: {square_isometry::identity, square_isometry::flip_x,
+                  square_isometry::flip_y, square_isometry::rotate_half,
+                  square_isometry::transpose, square_isometry::anti_transpose,
+                  square_isometry::rotate_cw, square_isometry::rotate_ccw}) {
+
+    details::fused_conversion fused{source.format(), source.endian(), target_format,
+      target_endian, 0, details::gamma_transfer::between(gamma, 1.f), iso};
+
+    auto result = fused.apply(source);
+
+    pixel_buffer expected = source;
+    convert_gamma(expected, 1.f, gamma);
+    convert_orientation(expected, iso);
+    convert_pixel_format(expected, target_format, target_endian);
+
+    id_assert(same_pixels(result, expected),
+        "fused conversion " + to_string(source.format()) + " -> " + to_string(target_format)
+        + " with " + to_string(iso) + " differs from separate passes");
+  }
+}
+
+
+
+void test_fused_conversion() {
+  auto foreign = std::endian::native == std::endian::little ?
+                   std::endian::big : std::endian::little;
+
+  auto rgb8 = create_buffer<rgb<u8>>(83, 45, pixel_id<rgb<u8>>);
+  test_fused_conversion(rgb8, rgba<f32>::format(), std::endian::native, 1.f);
+  test_fused_conversion(rgb8, rgba<u16>::format(), foreign, 1.f);
+  test_fused_conversion(rgb8, rgb<f16>::format(), std::endian::native, 1.f);
+
+  pixel_buffer gray16 = create_buffer<gray_a<u16>>(70, 131, pixel_id<gray_a<u16>>);
+  convert_endian(gray16, foreign);
+  test_fused_conversion(gray16, rgba<u8>::format(), std::endian::native, 1.f);
+  test_fused_conversion(gray16, gray_a<f32>::format(), foreign, 1.f);
+
+  auto rgbaf = create_buffer<rgba<f32>>(64, 33, [](size_t x, size_t y) {
+    auto v = static_cast<f32>(x + y) / 100.f;
+    return rgba<f32>{.r = v, .g = v / 2.f, .b = 1.f - v, .a = 0.5f};
+  });
+  test_fused_conversion(rgbaf, rgba<u8>::format(), std::endian::native, 2.2f);
+  test_fused_conversion(rgbaf, rgba<f16>::format(), foreign, 1.f / 2.2f);
+}
+
+
+
+
+
+void test_conversion_plan(const pixel_buffer& source, const output_format& fmt) {
+  frame first{pixel_buffer{source}};
+  conversion_plan plan{describe(first), fmt};
+
+  plan.apply(first);
+  id_assert(describe(first) == plan.target(),
+      "conversion_plan target does not describe the converted " + to_string(source.format()));
+
+
+  frame second{pixel_buffer{source}};
+  id_assert(plan.applicable(second), "conversion_plan not applicable to identical frame");
+  plan.apply(second);
+  id_assert(same_pixels(first.pixels(), second.pixels()),
+      "conversion_plan is not reusable for " + to_string(source.format()));
+
+
+  frame expected{pixel_buffer{source}};
+  make_format_compatible(expected, fmt);
+  id_assert(describe(expected) == describe(second) &&
+            same_pixels(expected.pixels(), second.pixels()),
+      "conversion_plan differs from make_format_compatible");
+
+
+  frame mismatch{pixel_buffer{source}};
+  mismatch.orientation(inverse(mismatch.orientation()) * square_isometry::flip_x);
+  id_assert(!plan.applicable(mismatch), "conversion_plan applicable to different frame");
+
+  bool thrown{false};
+  try {
+    plan.apply(mismatch);
+  } catch (const base_exception&) {
+    thrown = true;
+  }
+  id_assert(thrown, "conversion_plan applied to different frame");
+}
+
+
+
+void test_conversion_plan() {
+  auto foreign = std::endian::native == std::endian::little ?
+                   std::endian::big : std::endian::little;
+
+  auto rgb8 = create_buffer<rgb<u8>>(83, 45, pixel_id<rgb<u8>>);
+
+  pixel_buffer gray16 = create_buffer<gray_a<u16>>(70, 131, pixel_id<gray_a<u16>>);
+  convert_endian(gray16, foreign);
+
+  auto rgbaf = create_buffer<rgba<f32>>(64, 33, [](size_t x, size_t y) {
+    auto v = static_cast<f32>(x + y) / 100.f;
+    return rgba<f32>{.r = v, .g = v / 2.f, .b = 1.f - v, .a = 0.5f};
+  });
+
+
+  std::vector<output_format> formats;
+
+  formats.emplace_back(output_format::standard());
+  formats.back().enforce();
+
+  formats.emplace_back();
+  formats.back().data_format(data_format::f32);
+  formats.back().orientation(square_isometry::rotate_cw);
+
+  formats.emplace_back();
+  formats.back().alpha_mode(alpha_mode::premultiplied);
+  formats.back().gamma(gamma_linear);
+
+  formats.emplace_back();
+  formats.back().endian(foreign);
+  formats.back().data_format(data_format::u16);
+
+
+  for (const auto& fmt: formats) {
+    test_conversion_plan(rgb8,   fmt);
+    test_conversion_plan(gray16, fmt);
+    test_conversion_plan(rgbaf,  fmt);
+  }
+}
+
+
+
+
+
+void test_cpu_kernels() {
+  auto kernels = cpu_kernels();
+  id_assert(!kernels.empty(), "no cpu kernels registered");
+
+  //NOLINTNEXTLINE(*-mt-unsafe)
+  const char* limit = std::getenv("PIXGLOT_CPU_DISPATCH");
+  bool generic = limit != nullptr && std::string_view{limit} == "generic";
+
+  for (const auto& kernel: kernels) {
+    id_assert(!kernel.name.empty() && !kernel.variant.empty(), "unnamed cpu kernel");
+
+    if (generic) {
+      id_assert_eq(kernel.variant, std::string_view{"generic"});
+    }
+  }
+}
+
+
+
+
+
+template<pixel_type Src, pixel_type Tgt>
+void test_in_place_conversion(
+    size_t      width,
+    size_t      height,
+    bool        in_place,
+    std::endian endian,
+    auto&&      generator
+) {
+  pixel_buffer pixels = create_buffer<Src>(width, height, generator);
+  convert_endian(pixels, endian);
+
+  const auto* data = pixels.data().data();
+
+  convert_pixel_format(pixels, Tgt::format());
+
+  id_assert((pixels.data().data() == data) == in_place,
+      "unexpected allocation converting " + to_string(Src::format()) + " to "
+      + to_string(Tgt::format()));
+
+  id_assert_eq(pixels.stride(), pixel_buffer::stride_for_width(width, Tgt::format()));
+
+  for (size_t y = 0; y < height; ++y) {
+    auto row = pixels.row<Tgt>(y);
+    for (size_t x = 0; x < width; ++x) {
+      auto expected = pixel_cast<Tgt>(static_cast<Src>(generator(x, y)));
+      id_assert(std::ranges::equal(std::as_bytes(std::span{&row[x], 1}),
+                                   std::as_bytes(std::span{&expected, 1})),
+          "in-place conversion " + to_string(Src::format()) + " to "
+          + to_string(Tgt::format()) + " differs");
+    }
+  }
+}
+
+
+
+void test_in_place_conversion() {
+  auto foreign = std::endian::native == std::endian::little ?
+                   std::endian::big : std::endian::little;
+
+  auto native = std::endian::native;
+
+  auto float_id = [](size_t x, size_t y) {
+    auto v = static_cast<f32>((x * 7 + y * 3) % 97) / 96.f;
+    return rgba<f32>{.r = v, .g = 1.f - v, .b = v / 2.f, .a = 0.75f};
+  };
+
+  test_in_place_conversion<rgba<u16>, rgba<u8>>(301, 7, true, native,  pixel_id<rgba<u16>>);
+  test_in_place_conversion<rgba<u16>, rgba<u8>>(301, 7, true, foreign, pixel_id<rgba<u16>>);
+  test_in_place_conversion<rgb<u16>,  rgba<u8>>(513, 5, true, foreign, pixel_id<rgb<u16>>);
+  test_in_place_conversion<rgba<f32>, rgba<f16>>(77, 9, true, native,  float_id);
+  test_in_place_conversion<rgb<f32>,  rgba<u16>>(77, 9, true, native,  [&](size_t x, size_t y) {
+    auto v = float_id(x, y);
+    return rgb<f32>{.r = v.r, .g = v.g, .b = v.b};
+  });
+
+  test_in_place_conversion<gray_a<u8>, rgba<u8>>(8,  3, true,  native, pixel_id<gray_a<u8>>);
+  test_in_place_conversion<gray<u8>,   gray<u16>>(16, 3, true,  native, pixel_id<gray<u8>>);
+  test_in_place_conversion<gray<u8>,   rgb<u8>>  (64, 3, false, native, pixel_id<gray<u8>>);
+}
+
+
+
+
+
+void test_bottom_up() {
+  pixel_buffer top_down = create_buffer<rgb<u8>>(53, 29, pixel_id<rgb<u8>>);
+
+  pixel_buffer bottom_up = create_buffer<rgb<u8>>(53, 29, [](size_t x, size_t y) {
+    return pixel_id<rgb<u8>>(x, 28 - y);
+  });
+  bottom_up.bottom_up(true);
+
+  id_assert(same_pixels(top_down, bottom_up), "bottom_up does not reverse the rows");
+
+
+  const auto* data = top_down.data().data();
+  convert_orientation(top_down, square_isometry::flip_y);
+  id_assert(top_down.bottom_up() && top_down.data().data() == data,
+      "flip_y copied the pixel data");
+  convert_orientation(top_down, square_isometry::flip_y);
+
+
+  for (auto iso: {square_isometry::flip_x, square_isometry::rotate_half,
+                  square_isometry::transpose, square_isometry::rotate_cw}) {
+    pixel_buffer lhs = top_down;
+    pixel_buffer rhs = bottom_up;
+    convert_orientation(lhs, iso);
+    convert_orientation(rhs, iso);
+    id_assert(same_pixels(lhs, rhs), "bottom_up source differs for " + to_string(iso));
+  }
+
+
+  for (auto target: {rgba<u16>::format(), rgb<f32>::format()}) {
+    pixel_buffer lhs = top_down;
+    pixel_buffer rhs = bottom_up;
+    convert_pixel_format(lhs, target, std::endian::native);
+    convert_pixel_format(rhs, target, std::endian::native);
+    id_assert(same_pixels(lhs, rhs), "bottom_up source differs for " + to_string(target));
+
+    details::fused_conversion fused{rgb<u8>::format(), std::endian::native,
+      target, std::endian::native, 0, {}, square_isometry::rotate_ccw};
+    id_assert(same_pixels(fused.apply(top_down), fused.apply(bottom_up)),
+        "bottom_up source differs for fused " + to_string(target));
+  }
+}
+
+
+
+
+
+void test_sub_buffer() {
+  pixel_buffer sheet = create_buffer<rgba<u8>>(67, 41, pixel_id<rgba<u8>>);
+  pixel_buffer pristine = sheet;
+
+  for (auto iso: {square_isometry::flip_x, square_isometry::rotate_cw}) {
+    pixel_buffer tile = sheet.sub_buffer(5, 9, 31, 17);
+    pixel_buffer expected = tile;
+
+    convert_orientation(tile, square_isometry::identity, iso);
+    convert_orientation(expected, square_isometry::identity, iso);
+    id_assert(same_pixels(tile, expected), "sub_buffer differs for " + to_string(iso));
+  }
+
+  pixel_buffer tile = sheet.sub_buffer(11, 3, 40, 29);
+  pixel_buffer expected = tile;
+
+  convert_pixel_format(tile, rgba<u16>::format(), std::endian::big);
+  convert_pixel_format(expected, rgba<u16>::format(), std::endian::big);
+  id_assert(same_pixels(tile, expected), "sub_buffer pixel format conversion differs");
+
+  pixel_buffer shades = create_buffer<gray<u16>>(33, 12, pixel_id<gray<u16>>);
+  pixel_buffer shades_tile = shades.sub_buffer(1, 1, 20, 10);
+  convert_endian(shades_tile, std::endian::big == std::endian::native ?
+                                std::endian::little : std::endian::big);
+  convert_gamma(shades_tile, 1.f, 2.2f);
+  id_assert(same_pixels(shades, create_buffer<gray<u16>>(33, 12, pixel_id<gray<u16>>)),
+      "conversion of a sub_buffer modified its parent");
+
+  id_assert(same_pixels(sheet, pristine), "conversion of a sub_buffer modified its parent");
+
+
+  // the tile no longer shares its storage, but keeps the stride of the dropped parent
+  pixel_buffer orphan = [] {
+    pixel_buffer wide = create_buffer<gray<u8>>(1024, 8, pixel_id<gray<u8>>);
+    return wide.sub_buffer(0, 0, 300, 8);
+  }();
+  pixel_buffer orphan_expected = orphan;
+
+  convert_pixel_format(orphan, gray<u16>::format());
+  convert_pixel_format(orphan_expected, gray<u16>::format());
+  id_assert(same_pixels(orphan, orphan_expected), "orphaned sub_buffer conversion differs");
+}
+
+
+
+
+
+[[nodiscard]] indexed_buffer create_indexed(
+    size_t         width,
+    size_t         height,
+    color_channels channels
+) {
+  std::vector<rgba<u8>> palette(200);
+  for (size_t i = 0; i < palette.size(); ++i) {
+    auto v = static_cast<u8>(i);
+    palette[i] = rgba<u8>{.r = v, .g = static_cast<u8>(255 - v),
+                          .b = static_cast<u8>(v * 3), .a = static_cast<u8>(v | 1)};
+  }
+
+  indexed_buffer indexed{width, height, palette, channels};
+  for (size_t y = 0; y < height; ++y) {
+    auto row = indexed.indices().row<gray<u8>>(y);
+    for (size_t x = 0; x < width; ++x) {
+      row[x].v = static_cast<u8>(x * 7 + y * 13);
+    }
+  }
+
+  return indexed;
+}
+
+
+
+void test_indexed_expansion(color_channels channels) {
+  indexed_buffer source = create_indexed(203, 7, channels);
+
+  frame expanded{indexed_buffer{source}};
+  convert_storage(expanded, storage_type::pixel_buffer);
+  id_assert_eq(expanded.format(), source.format());
+
+  const auto& table = source.lookup_table();
+  for (size_t y = 0; y < source.height(); ++y) {
+    auto indices = source.indices().row<gray<u8>>(y);
+    for (size_t x = 0; x < source.width(); ++x) {
+      auto color = table.at(indices[x].v);
+
+      if (channels == color_channels::rgba) {
+        id_assert_eq(expanded.pixels().row<rgba<u8>>(y)[x], color);
+      } else {
+        id_assert_eq(expanded.pixels().row<rgb<u8>>(y)[x],
+                     (rgb<u8>{.r = color.r, .g = color.g, .b = color.b}));
+      }
+    }
+  }
+}
+
+
+
+void test_indexed() {
+  test_indexed_expansion(color_channels::rgba);
+  test_indexed_expansion(color_channels::rgb);
+
+
+  output_format fmt;
+  fmt.storage_type(preference{storage_type::indexed, preference_level::prefer});
+  fmt.alpha_mode(alpha_mode::premultiplied);
+  fmt.orientation(square_isometry::rotate_cw);
+
+  frame indexed{create_indexed(37, 11, color_channels::rgba)};
+  make_format_compatible(indexed, fmt);
+  id_assert_eq(indexed.type(), storage_type::indexed);
+
+  frame expected{create_indexed(37, 11, color_channels::rgba)};
+  convert_storage(expected, storage_type::pixel_buffer);
+  make_format_compatible(expected, fmt);
+
+  convert_storage(indexed, storage_type::pixel_buffer);
+  id_assert(same_pixels(indexed.pixels(), expected.pixels()),
+      "indexed conversion differs from conversion of the expanded pixels");
+
+
+  fmt.data_format(data_format::u16);
+  frame widened{create_indexed(5, 3, color_channels::rgb)};
+  make_format_compatible(widened, fmt);
+  id_assert_eq(widened.type(), storage_type::pixel_buffer);
+  id_assert_eq(widened.format(), rgb<u16>::format());
+
+
+  bool thrown{false};
+  try {
+    frame pixels{pixel_buffer{4, 4, rgba<u8>::format()}};
+    convert_storage(pixels, storage_type::indexed);
+  } catch (const base_exception&) {
+    thrown = true;
+  }
+  id_assert(thrown, "conversion to indexed storage did not throw");
+
+  thrown = false;
+  try {
+    indexed_buffer oversized{1, 1, std::vector<rgba<u8>>(257)};
+  } catch (const base_exception&) {
+    thrown = true;
+  }
+  id_assert(thrown, "palette with more than 256 entries accepted");
+}
+
+
+
+
+
+[[nodiscard]] yuv_buffer create_yuv(
+    size_t             width,
+    size_t             height,
+    chroma_subsampling subsampling,
+    u8                 cb,
+    u8                 cr
+) {
+  yuv_buffer yuv{width, height, subsampling};
+
+  for (size_t y = 0; y < height; ++y) {
+    auto row = yuv.y().row<gray<u8>>(y);
+    for (size_t x = 0; x < width; ++x) {
+      row[x].v = static_cast<u8>(x * 7 + y * 13);
+    }
+  }
+
+  std::ranges::fill(yuv.u().data(), std::byte{cb});
+  std::ranges::fill(yuv.v().data(), std::byte{cr});
+
+  return yuv;
+}
+
+
+
+void test_yuv() {
+  id_assert_eq(yuv_buffer::chroma_width (7, chroma_subsampling::cs420), 4u);
+  id_assert_eq(yuv_buffer::chroma_height(7, chroma_subsampling::cs420), 4u);
+  id_assert_eq(yuv_buffer::chroma_height(7, chroma_subsampling::cs422), 7u);
+  id_assert_eq(yuv_buffer::chroma_width (7, chroma_subsampling::cs444), 7u);
+
+
+  // neutral chroma leaves only luma
+  frame gray_frame{create_yuv(31, 9, chroma_subsampling::cs420, 128, 128)};
+  convert_storage(gray_frame, storage_type::pixel_buffer);
+  id_assert_eq(gray_frame.format(), rgb<u8>::format());
+
+  for (size_t y = 0; y < 9; ++y) {
+    for (size_t x = 0; x < 31; ++x) {
+      auto v = static_cast<u8>(x * 7 + y * 13);
+      id_assert_eq(gray_frame.pixels().row<rgb<u8>>(y)[x],
+                   (rgb<u8>{.r = v, .g = v, .b = v}));
+    }
+  }
+
+
+  // constant chroma is not changed by the upsampling
+  frame tinted{create_yuv(13, 5, chroma_subsampling::cs422, 90, 200)};
+  convert_storage(tinted, storage_type::pixel_buffer);
+
+  auto coeffs = details::yuv_to_rgb(yuv_matrix::bt601, true);
+  for (size_t y = 0; y < 5; ++y) {
+    for (size_t x = 0; x < 13; ++x) {
+      auto l = static_cast<float>(static_cast<u8>(x * 7 + y * 13));
+      auto expected = rgb<u8> {
+        .r = static_cast<u8>(std::clamp(std::round(l + coeffs.cr_r * 72.f), 0.f, 255.f)),
+        .g = static_cast<u8>(std::clamp(
+               std::round(l - coeffs.cb_g * 38.f + coeffs.cr_g * 72.f), 0.f, 255.f)),
+        .b = static_cast<u8>(std::clamp(std::round(l - coeffs.cb_b * 38.f), 0.f, 255.f)),
+      };
+      id_assert_eq(tinted.pixels().row<rgb<u8>>(y)[x], expected);
+    }
+  }
+
+
+  output_format fmt;
+  fmt.storage_type(preference{storage_type::yuv, preference_level::prefer});
+
+  frame kept{create_yuv(8, 8, chroma_subsampling::cs420, 100, 150)};
+  make_format_compatible(kept, fmt);
+  id_assert_eq(kept.type(), storage_type::yuv);
+
+  fmt.orientation(square_isometry::rotate_cw);
+  frame rotated{create_yuv(8, 6, chroma_subsampling::cs420, 100, 150)};
+  frame expected{create_yuv(8, 6, chroma_subsampling::cs420, 100, 150)};
+  make_format_compatible(rotated, fmt);
+  id_assert_eq(rotated.type(), storage_type::pixel_buffer);
+
+  convert_storage(expected, storage_type::pixel_buffer);
+  make_format_compatible(expected, fmt);
+  id_assert(same_pixels(rotated.pixels(), expected.pixels()),
+      "yuv conversion differs from conversion of the expanded pixels");
+
+
+  bool thrown{false};
+  try {
+    frame pixels{pixel_buffer{4, 4, rgb<u8>::format()}};
+    convert_storage(pixels, storage_type::yuv);
+  } catch (const base_exception&) {
+    thrown = true;
+  }
+  id_assert(thrown, "conversion to yuv storage did not throw");
+}
+
+
+
+
+
+void test_texture_layers() {
+  frame layered{16, 9, rgba<u8>::format()};
+  layered.layer(3);
+  id_assert_eq(describe(layered).storage_type, storage_type::gl_texture);
+
+  output_format fmt;
+  fmt.storage_type(storage_type::gl_texture);
+  fmt.texture_array(true);
+  fmt.data_format(data_format::u8);
+  make_format_compatible(layered, fmt);
+  id_assert(layered.layer() == 3u, "conversion without pixel changes dropped the layer");
+  id_assert_eq(layered.type(), storage_type::no_pixels);
+
+
+  bool thrown{false};
+  try {
+    fmt.data_format(data_format::u16);
+    make_format_compatible(layered, fmt);
+  } catch (const base_exception&) {
+    thrown = true;
+  }
+  id_assert(thrown, "pixels of a single layered frame converted");
+
+  thrown = false;
+  try {
+    convert_storage(layered, storage_type::pixel_buffer);
+  } catch (const base_exception&) {
+    thrown = true;
+  }
+  id_assert(thrown, "storage of a single layered frame converted");
+
+
+  layered.reset(pixel_buffer{16, 9, rgba<u8>::format()});
+  id_assert(!layered.layer(), "frame with own pixels still refers to a layer");
+}
+
+
+
+
+
+void test_mipmap_capable() {
+  id_assert(gl_texture::mipmap_capable(rgba<u8>::format()),  "rgba<u8> without mipmaps");
+  id_assert(gl_texture::mipmap_capable(rgb<f16>::format()),  "rgb<f16> without mipmaps");
+  id_assert(gl_texture::mipmap_capable(rgba<f32>::format()), "rgba<f32> without mipmaps");
+
+  id_assert(!gl_texture::mipmap_capable(gray<u32>::format()), "gray<u32> has mipmaps");
+  id_assert(!gl_texture::mipmap_capable(rgba<u32>::format()), "rgba<u32> has mipmaps");
+  id_assert(!gl_texture::mipmap_capable(rgb<f32>::format()),  "rgb<f32> has mipmaps");
+}
+
+
+
+
+
+void test_changed_region() {
+  frame f{pixel_buffer{16, 9, rgba<u8>::format()}};
+  frame_region region{.x = 2, .y = 3, .width = 5, .height = 4};
+  f.changed_region(region);
+
+  convert_gamma(f, gamma_linear);
+  id_assert(f.changed_region() == region, "gamma conversion dropped the changed region");
+
+  output_format fmt;
+  fmt.orientation(square_isometry::rotate_cw);
+  make_format_compatible(f, fmt);
+  id_assert(!f.changed_region(), "changed region survived a rotation of the pixels");
+}
+
+
+
+
+
+// The texture unit decodes GL_SRGB8(_ALPHA8) with the exact sRGB curve, which the
+// software path follows for gamma_s_rgb as well.
+void test_srgb_texture() {
+  id_assert_eq(utils::gl_internal_format(rgba<u8>::format(), true), GL_SRGB8_ALPHA8);
+  id_assert_eq(utils::gl_internal_format(rgb<u8>::format(),  true), GL_SRGB8);
+  id_assert_eq(utils::gl_internal_format(rgba<u8>::format()),       GL_RGBA8);
+  id_assert(utils::pixel_format_from_gl_internal(GL_SRGB8_ALPHA8) == rgba<u8>::format(),
+      "GL_SRGB8_ALPHA8 is not rgba<u8>");
+  id_assert(!gl_texture::srgb_capable(gray<u8>::format()), "gray<u8> has an sRGB format");
+  id_assert(!gl_texture::srgb_capable(rgba<u16>::format()), "rgba<u16> has an sRGB format");
+
+  bool thrown{false};
+  try {
+    std::ignore = utils::gl_internal_format(gray_a<u8>::format(), true);
+  } catch (const base_exception&) {
+    thrown = true;
+  }
+  id_assert(thrown, "sRGB internal format for gray_a<u8>");
+
+
+  auto hardware = [](u8 value) {
+    double x = value / 255.;
+    return x <= 0.04045 ? x / 12.92 : std::pow((x + 0.055) / 1.055, 2.4);
+  };
+
+  frame software{create_buffer<rgba<u8>>(256, 1, [](size_t x, size_t /*y*/) {
+    auto v = static_cast<u8>(x);
+    return rgba<u8>{.r = v, .g = v, .b = v, .a = 0xff};
+  })};
+
+  output_format fmt;
+  fmt.data_format(data_format::f32);
+  fmt.gamma(gamma_linear);
+  make_format_compatible(software, fmt);
+
+  auto row = software.pixels().row<rgba<f32>>(0);
+  for (size_t x = 0; x < row.size(); ++x) {
+    auto expected = hardware(static_cast<u8>(x));
+    id_assert(std::abs(row[x].r - expected) < 1e-5, "software linearisation of "
+        + std::to_string(x) + " is " + std::to_string(row[x].r) + ", hardware gives "
+        + std::to_string(expected));
+  }
+}
+
+
+
+
+
+int main() {
+  test_cpu_kernels();
+
+  test_half_float_to_float();
+  test_half_float_rounding();
+  test_half_float_integer();
+  test_foreign_endian();
+  test_gamma_u8(gamma_s_rgb, exact_srgb_to_linear);
+  test_gamma_u8(1.8f, details::gamma_transfer::power(1.8f));
+  test_gamma_u16_foreign_endian();
+  test_fast_pow();
+  test_fast_exp2_overflow();
+  test_srgb_transfer();
+  test_gamma_f32();
+  test_alpha_integer<u8>();
+  test_alpha_integer<u16>();
+  test_alpha_gray_f32();
+
+  test_orientation<gray<u8>>();
+  test_orientation<gray_a<u8>>();
+  test_orientation<rgb<u8>>();
+  test_orientation<rgba<u8>>();
+  test_orientation<rgb<u16>>();
+  test_orientation<rgba<u16>>();
+  test_orientation<rgb<f32>>();
+  test_orientation<rgba<f32>>();
+  test_bottom_up();
+  test_sub_buffer();
+  test_indexed();
+  test_yuv();
+
+  test_fused_conversion();
+  test_conversion_plan();
+  test_texture_layers();
+  test_mipmap_capable();
+  test_changed_region();
+  test_srgb_texture();
+  test_in_place_conversion();
+}
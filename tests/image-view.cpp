@@ -0,0 +1,76 @@
+#include "common.hpp"
+
+#include <iterator>
+
+#include <pixglot/image-view.hpp>
+
+using namespace pixglot;
+
+
+
+int main() {
+  static_assert(std::forward_iterator<image_view<rgba<u8>>::row_iterator>);
+  static_assert(std::forward_iterator<image_view<const rgba<u8>>::column_iterator>);
+
+
+
+  pixel_buffer buff{17, 9, gray<u16>::format()};
+  image_view<gray<u16>> view{buff};
+
+  id_assert_eq(view.width(),  buff.width());
+  id_assert_eq(view.height(), buff.height());
+  id_assert_eq(view.stride(), buff.signed_stride());
+
+  for (size_t y = 0; y < view.height(); ++y) {
+    for (size_t x = 0; x < view.width(); ++x) {
+      view[x, y] = gray<u16>{static_cast<u16>(y * 100 + x)};
+    }
+  }
+
+  id_assert_eq(buff.row<gray<u16>>(4)[7].v, u16{407});
+
+
+
+  try {
+    image_view<rgba<u8>> wrong{buff};
+    exit(1);
+  } catch (const bad_pixel_format& ex) {
+    id_assert_eq(*ex.expected(), buff.format());
+  }
+
+
+
+  auto sub = view.subview(3, 2, 5, 4);
+  id_assert_eq(sub.width(),  size_t{5});
+  id_assert_eq(sub.height(), size_t{4});
+  id_assert_eq(sub[0, 0].v, u16{203});
+  id_assert_eq(sub.row(3)[4].v, u16{507});
+
+  try {
+    std::ignore = view.subview(13, 0, 5, 1);
+    exit(1);
+  } catch (const index_out_of_range&) {}
+
+
+
+  u16 expected{203};
+  for (auto row: sub.rows()) {
+    id_assert_eq(row.size(), sub.width());
+    id_assert_eq(row[0].v, expected);
+    expected += 100;
+  }
+
+  expected = 5;
+  for (const auto& pixel: image_view<const gray<u16>>{view}.column(5)) {
+    id_assert_eq(pixel.v, expected);
+    expected += 100;
+  }
+  id_assert_eq(expected, u16{905});
+
+
+
+  buff.bottom_up(true);
+  image_view<const gray<u16>> flipped{std::as_const(buff)};
+  id_assert_eq(flipped.stride(), -view.stride());
+  id_assert_eq((flipped[7, 8 - 4].v), u16{407});
+}
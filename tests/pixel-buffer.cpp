@@ -44,4 +44,61 @@ int main() {
   id_assert_eq(count, buff.height());
 
   id_assert(pixel_buffer::padding() >= 4);
+
+
+
+  pixel_buffer flipped{3, 4, gray<u8>::format()};
+  for (size_t y = 0; y < flipped.height(); ++y) {
+    flipped.row<gray<u8>>(y)[0] = gray<u8>{static_cast<u8>(y)};
+  }
+
+  flipped.bottom_up(true);
+  id_assert(flipped.bottom_up());
+  id_assert_eq(flipped.signed_stride(), -static_cast<ptrdiff_t>(flipped.stride()));
+  id_assert_eq(flipped.row<gray<u8>>(0)[0].v, u8{3});
+
+  u8 expected{3};
+  for (auto row: flipped.rows<gray<u8>>()) {
+    id_assert_eq(row[0].v, expected--);
+  }
+
+
+
+  pixel_buffer sheet{40, 30, rgb<u8>::format()};
+  for (size_t y = 0; y < sheet.height(); ++y) {
+    for (size_t x = 0; x < sheet.width(); ++x) {
+      sheet.row<rgb<u8>>(y)[x] = rgb<u8>{static_cast<u8>(x), static_cast<u8>(y), 0};
+    }
+  }
+
+  pixel_buffer tile = sheet.sub_buffer(8, 16, 16, 14);
+  id_assert(tile.shares_storage() && sheet.shares_storage());
+  id_assert_eq(tile.width(),  size_t{16});
+  id_assert_eq(tile.height(), size_t{14});
+  id_assert_eq(tile.stride(), sheet.stride());
+  id_assert_eq(tile.row<rgb<u8>>(13)[15].r, u8{23});
+  id_assert_eq(tile.row<rgb<u8>>(13)[15].g, u8{29});
+
+  tile.row<rgb<u8>>(0)[0].b = 0xff;
+  id_assert_eq(sheet.row<rgb<u8>>(16)[8].b, u8{0xff});
+
+  pixel_buffer copy = tile;
+  id_assert(!copy.shares_storage());
+  id_assert_eq(copy.stride(), pixel_buffer::stride_for_width(16, rgb<u8>::format()));
+  id_assert_eq(copy.row<rgb<u8>>(5)[3].r, u8{11});
+
+  try {
+    std::ignore = sheet.sub_buffer(30, 0, 11, 1);
+    exit(1);
+  } catch (const index_out_of_range&) {}
+
+  sheet.bottom_up(true);
+  pixel_buffer flipped_tile = sheet.sub_buffer(0, 2, 4, 3);
+  id_assert(flipped_tile.bottom_up());
+  id_assert_eq(flipped_tile.row<rgb<u8>>(0)[0].g, u8{27});
+  id_assert_eq(flipped_tile.row<rgb<u8>>(2)[0].g, u8{25});
+
+  tile.unshare();
+  id_assert(!tile.shares_storage());
+  id_assert_eq(tile.row<rgb<u8>>(0)[0].b, u8{0xff});
 }
@@ -2,7 +2,7 @@
 
 #include <array>
 
-#include <pixglot/decode.hpp>
+#include <pixglot/decode-as.hpp>
 
 using namespace pixglot;
 
@@ -51,9 +51,51 @@ void test_black_white(const image& img) {
 
 
 
+void test_decode_as(const char* path) {
+  auto typed = decode_as<rgba<u16>>(reader{path});
+
+  id_assert_eq(typed.size(), 1u);
+  id_assert_eq(typed.frame().format(), rgba<u16>::format());
+  id_assert_eq(typed.frame().alpha_mode(), alpha_mode::straight);
+
+  auto view = typed.view();
+  for (size_t y = 0; y < view.height(); ++y) {
+    for (size_t x = 0; x < view.width(); ++x) {
+      auto expected = static_cast<u16>(black_white.at(y * 6 + x) * 0x101);
+      id_assert_eq(view[x, y].r, expected);
+      id_assert_eq(view[x, y].b, expected);
+      id_assert_eq(view[x, y].a, u16{0xffff});
+    }
+  }
+}
+
+
+
+
+
+void test_decode_as_luma(const char* path) {
+  // red where black_white is black, luma of red is 0.2126 * 255
+  auto typed = decode_as<gray<u8>>(reader{path});
+
+  id_assert_eq(typed.frame().format(), gray<u8>::format());
+  id_assert_eq(typed.frame().alpha_mode(), alpha_mode::none);
+
+  auto view = typed.view();
+  for (size_t y = 0; y < view.height(); ++y) {
+    for (size_t x = 0; x < view.width(); ++x) {
+      auto expected = black_white.at(y * 6 + x) == 0 ? u8{54} : u8{0xff};
+      id_assert_eq(view[x, y].v, expected);
+    }
+  }
+}
+
+
+
+
+
 //NOLINTBEGIN(*-pointer-arithmetic)
 int main(int argc, char** argv) {
-  // usage: .. <file> [--gray]
+  // usage: .. <file> [--gray|--red]
   id_assert(argc == 2 || argc == 3);
 
   id_assert_eq(determine_codec(argv[1]), codec::ppm);
@@ -64,6 +106,11 @@ int main(int argc, char** argv) {
 
   if (argc > 2 && argv[2] == std::string_view{"--gray"}) {
     test_black_white(image);
+    test_decode_as(argv[1]);
+  }
+
+  if (argc > 2 && argv[2] == std::string_view{"--red"}) {
+    test_decode_as_luma(argv[1]);
   }
 }
 //NOLINTEND(*-pointer-arithmetic)